@@ -32,6 +32,7 @@
 
 #include <openvdb_points/tools/AttributeArray.h>
 #include <openvdb_points/tools/AttributeArrayString.h>
+#include <openvdb_points/tools/AttributeArrayVariable.h>
 #include <openvdb_points/tools/AttributeGroup.h>
 #include <openvdb_points/tools/PointDataGrid.h>
 
@@ -58,44 +59,38 @@ initialize()
     Lock lock(sInitMutex);
     if (sIsInitialized) return;
 
-    // no compression
+    // typed attributes, with each of the codecs listed for their value type
+    // in attribute_traits::RegisteredCodecs
 
-    TypedAttributeArray<bool>::registerType();
-    TypedAttributeArray<int16_t>::registerType();
-    TypedAttributeArray<int32_t>::registerType();
-    TypedAttributeArray<int64_t>::registerType();
-    TypedAttributeArray<float>::registerType();
-    TypedAttributeArray<double>::registerType();
-    TypedAttributeArray<Vec3<int32_t> >::registerType();
-    TypedAttributeArray<Vec3<float> >::registerType();
-    TypedAttributeArray<Vec3<double> >::registerType();
-
-    // group and string attribute
-
-    GroupAttributeArray::registerType();
-    StringAttributeArray::registerType();
+    registerTypedAttributeArrays<bool>();
+    registerTypedAttributeArrays<int16_t>();
+    registerTypedAttributeArrays<int32_t>();
+    registerTypedAttributeArrays<int64_t>();
+    registerTypedAttributeArrays<float>();
+    registerTypedAttributeArrays<double>();
+    registerTypedAttributeArrays<Vec3<int32_t> >();
+    registerTypedAttributeArrays<Vec3<float> >();
+    registerTypedAttributeArrays<Vec3<double> >();
 
     // matrix and quaternion attributes
 
-    TypedAttributeArray<math::Mat4<float> >::registerType();
-    TypedAttributeArray<math::Mat4<double> >::registerType();
+    registerTypedAttributeArrays<math::Mat4<float> >();
+    registerTypedAttributeArrays<math::Mat4<double> >();
 
-    TypedAttributeArray<math::Quat<float> >::registerType();
-    TypedAttributeArray<math::Quat<double> >::registerType();
+    registerTypedAttributeArrays<math::Quat<float> >();
+    registerTypedAttributeArrays<math::Quat<double> >();
 
-    // truncate compression
-
-    TypedAttributeArray<float, TruncateCodec>::registerType();
-    TypedAttributeArray<Vec3<float>, TruncateCodec>::registerType();
-
-    // fixed point compression
+    // group and string attribute
 
-    TypedAttributeArray<Vec3<float>, FixedPointCodec<true> >::registerType();
-    TypedAttributeArray<Vec3<float>, FixedPointCodec<false> >::registerType();
+    GroupAttributeArray::registerType();
+    StringAttributeArray::registerType();
 
-    // unit vector compression
+    // variable-length attributes
 
-    TypedAttributeArray<Vec3<float>, UnitVecCodec>::registerType();
+    VariableAttributeArray<int32_t>::registerType();
+    VariableAttributeArray<int64_t>::registerType();
+    VariableAttributeArray<float>::registerType();
+    VariableAttributeArray<Vec3<float> >::registerType();
 
     // Register types associated with point data grids.
     Metadata::registerType(typeNameAsString<PointDataIndex32>(), Int32Metadata::createMetadata);
@@ -32,199 +32,1161 @@
 ///
 /// @authors Dan Bailey, Mihai Alden, Peter Cucka
 
+#include <algorithm> // std::min, std::max, std::rotate
+#include <cmath>
 #include <map>
+#include <vector>
 
 #include <openvdb_points/tools/AttributeArray.h>
 
+#include <tbb/task_scheduler_init.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h> // madvise()
+#endif
+
+// batched codec kernels are selected at runtime on x86 with GCC-compatible compilers
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define OPENVDB_POINTS_X86_CODEC_KERNELS
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #ifdef OPENVDB_USE_BLOSC
 #include <blosc.h>
 #endif
 
-namespace openvdb {
-OPENVDB_USE_VERSION_NAMESPACE
-namespace OPENVDB_VERSION_NAME {
-namespace tools {
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+////////////////////////////////////////
+
+namespace attribute_compression {
+
+
+namespace {
+
+// maximum number of threads used by a single Blosc call (zero for the default)
+tbb::atomic<int> sMaxThreads;
+
+// number of ScopedThreads objects alive on each thread
+typedef tbb::enumerable_thread_specific<int> ScopeDepths;
+
+ScopeDepths sThreadedScopes;
+
+} // unnamed namespace
+
+
+void setMaxThreads(const int threads)
+{
+    sMaxThreads = std::max(0, threads);
+}
+
+
+int maxThreads()
+{
+    const int threads = sMaxThreads;
+    return threads > 0 ? threads : tbb::task_scheduler_init::default_num_threads();
+}
+
+
+ScopedThreads::ScopedThreads()
+{
+    ++sThreadedScopes.local();
+}
+
+
+ScopedThreads::~ScopedThreads()
+{
+    --sThreadedScopes.local();
+}
+
+
+const char* Settings::compressorName() const
+{
+    // these match the Blosc compressor names (BLOSC_*_COMPNAME)
+
+    static const char* names[] = { "blosclz", "lz4", "lz4hc", "snappy", "zlib", "zstd" };
+
+    if (compressor > ZSTD)  return names[LZ4];
+    return names[compressor];
+}
+
+
+#ifdef OPENVDB_USE_BLOSC
+
+
+namespace {
+
+// thread-local scratch space for compression, as the compressed size is not known
+// in advance this avoids allocating a padded buffer on every call
+typedef tbb::enumerable_thread_specific<std::vector<char> > ScratchBuffers;
+
+ScratchBuffers sScratchBuffers;
+
+// scratch space is retained between calls up to this size, beyond this it is released after
+// each call so that every thread doesn't hold on to a buffer the size of the largest array
+const size_t sMaxScratchBytes = size_t(4) << 20;
+
+void trimScratch()
+{
+    std::vector<char>& scratchBuffer = sScratchBuffers.local();
+    if (scratchBuffer.capacity() > sMaxScratchBytes)   std::vector<char>().swap(scratchBuffer);
+}
+
+// owns a heap-allocated buffer until released, so that it is freed if an exception is thrown
+class ScopedBuffer
+{
+public:
+    explicit ScopedBuffer(const size_t bytes) : mBuffer(new char[bytes]) { }
+    ~ScopedBuffer() { delete[] mBuffer; }
+
+    char* get() const { return mBuffer; }
+    char* release() { char* buffer = mBuffer; mBuffer = 0; return buffer; }
+
+private:
+    ScopedBuffer(const ScopedBuffer&);
+    ScopedBuffer& operator=(const ScopedBuffer&);
+
+    char* mBuffer;
+}; // class ScopedBuffer
+
+// Blosc only benefits from additional threads on large buffers
+const size_t sMinBytesPerThread = size_t(1) << 20;
+
+// guards the global Blosc context, which is used for multi-threaded calls so that
+// its thread pool persists between calls rather than being created for each one
+tbb::spin_mutex sGlobalContextMutex;
+
+// number of threads the global Blosc context is configured with (guarded by the mutex)
+int sGlobalContextThreads = 0;
+
+// selects the Blosc context for a call, large buffers use the global context with multiple
+// threads if the calling thread is within a ScopedThreads and no other multi-threaded call is
+// in progress, otherwise a single-threaded call is made using a local context
+class ScopedBloscContext
+{
+public:
+    explicit ScopedBloscContext(const size_t bytes)
+        : mThreads(1)
+    {
+        if (sThreadedScopes.local() == 0 || bytes < 2 * sMinBytesPerThread)   return;
+
+        const size_t threads = std::min(size_t(maxThreads()), bytes / sMinBytesPerThread);
+        if (threads < 2 || !mLock.try_acquire(sGlobalContextMutex))         return;
+
+        mThreads = int(threads);
+
+        if (mThreads != sGlobalContextThreads) {
+            blosc_set_nthreads(mThreads);
+            sGlobalContextThreads = mThreads;
+        }
+    }
+
+    bool isGlobal() const { return mThreads > 1; }
+
+private:
+    tbb::spin_mutex::scoped_lock mLock;
+    int mThreads;
+}; // class ScopedBloscContext
+
+// compress into thread-local scratch space and return the number of compressed bytes
+// (or zero if compression failed), the scratch space is valid until the next call
+size_t compressToScratch(const char* buffer, const size_t typeSize,
+                         const size_t uncompressedBytes, const Settings& settings,
+                         const char*& scratch)
+{
+    const size_t tempBytes = uncompressedBytes + BLOSC_MAX_OVERHEAD;
+
+    if (tempBytes > BLOSC_MAX_BUFFERSIZE) {
+        OPENVDB_LOG_DEBUG("Blosc can't compress " << uncompressedBytes << " bytes");
+        return 0;
+    }
+
+    std::vector<char>& scratchBuffer = sScratchBuffers.local();
+    if (scratchBuffer.size() < tempBytes)   scratchBuffer.resize(tempBytes);
+
+    ScopedBloscContext context(uncompressedBytes);
+
+    int compressedBytes;
+
+    if (context.isGlobal()) {
+        blosc_set_compressor(settings.compressorName());
+        blosc_set_blocksize(settings.blockSize);
+
+        compressedBytes = blosc_compress(
+            /*clevel=*/settings.level,
+            /*doshuffle=*/settings.shuffle,
+            /*typesize=*/typeSize,
+            /*srcsize=*/uncompressedBytes,
+            /*src=*/buffer,
+            /*dest=*/&scratchBuffer[0],
+            /*destsize=*/tempBytes);
+    }
+    else {
+        compressedBytes = blosc_compress_ctx(
+            /*clevel=*/settings.level,
+            /*doshuffle=*/settings.shuffle,
+            /*typesize=*/typeSize,
+            /*srcsize=*/uncompressedBytes,
+            /*src=*/buffer,
+            /*dest=*/&scratchBuffer[0],
+            /*destsize=*/tempBytes,
+            settings.compressorName(),
+            /*blocksize=*/settings.blockSize,
+            /*numthreads=*/1);
+    }
+
+    if (compressedBytes <= 0) {
+        std::ostringstream ostr;
+        ostr << "Blosc failed to compress " << uncompressedBytes << " byte" << (uncompressedBytes == 1 ? "" : "s");
+        if (compressedBytes < 0) ostr << " (internal error " << compressedBytes << ")";
+        OPENVDB_LOG_DEBUG(ostr.str());
+        return 0;
+    }
+
+    scratch = &scratchBuffer[0];
+    return size_t(compressedBytes);
+}
+
+} // unnamed namespace
+
+
+bool canCompress()
+{
+    return true;
+}
+
+
+size_t uncompressedSize(const char* buffer)
+{
+    size_t bytes, _1, _2;
+    blosc_cbuffer_sizes(buffer, &bytes, &_1, &_2);
+    return bytes;
+}
+
+
+size_t compressedSize( const char* buffer, const size_t typeSize, const size_t uncompressedBytes,
+                       const Settings& settings)
+{
+    const char* scratch = NULL;
+    const size_t bytes = compressToScratch(buffer, typeSize, uncompressedBytes, settings, scratch);
+    trimScratch();
+    return bytes;
+}
+
+
+char* compress( char* buffer, const size_t typeSize,
+                const size_t uncompressedBytes, size_t& compressedBytes, const bool cleanup,
+                const Settings& settings)
+{
+    const char* scratch = NULL;
+    const size_t _compressedBytes = compressToScratch(buffer, typeSize, uncompressedBytes, settings, scratch);
+
+    if (_compressedBytes == 0) {
+        trimScratch();
+        return 0;
+    }
+
+    // optionally cleanup uncompressed buffer if requested (prior to allocating new compressed buffer)
+
+    if (cleanup)    delete[] buffer;
+
+    compressedBytes = _compressedBytes;
+
+    char* outData = new char[compressedBytes];
+    std::memcpy(outData, scratch, compressedBytes);
+    trimScratch();
+    return outData;
+}
+
+
+bool decompress(const char* buffer, char* outBuffer, const size_t expectedBytes)
+{
+    if (expectedBytes + BLOSC_MAX_OVERHEAD > BLOSC_MAX_BUFFERSIZE) {
+        OPENVDB_LOG_DEBUG("Blosc can't decompress " << expectedBytes << " bytes");
+        return false;
+    }
+
+    size_t uncompressedBytes, _1, _2;
+    blosc_cbuffer_sizes(buffer, &uncompressedBytes, &_1, &_2);
+
+    if (uncompressedBytes != expectedBytes) {
+        OPENVDB_THROW(RuntimeError, "Expected to decompress " << expectedBytes
+            << " byte" << (expectedBytes == 1 ? "" : "s") << ", got "
+            << uncompressedBytes << " byte" << (uncompressedBytes == 1 ? "" : "s"));
+    }
+
+    // decompress directly into the output buffer as the uncompressed size is known
+
+    ScopedBloscContext context(expectedBytes);
+
+    const int _uncompressedBytes = context.isGlobal() ?
+        blosc_decompress(/*src=*/buffer, /*dest=*/outBuffer, expectedBytes) :
+        blosc_decompress_ctx(/*src=*/buffer, /*dest=*/outBuffer, expectedBytes, /*numthreads=*/1);
+
+    if (_uncompressedBytes < 1) {
+        OPENVDB_LOG_DEBUG("blosc_decompress() returned error code " << _uncompressedBytes);
+        return false;
+    }
+
+    return true;
+}
+
+
+char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup)
+{
+    if (expectedBytes + BLOSC_MAX_OVERHEAD > BLOSC_MAX_BUFFERSIZE) {
+        OPENVDB_LOG_DEBUG("Blosc can't decompress " << expectedBytes << " bytes");
+        return 0;
+    }
+
+    ScopedBuffer newBuffer(expectedBytes);
+
+    if (!decompress(const_cast<const char*>(buffer), newBuffer.get(), expectedBytes)) {
+        return 0;
+    }
+
+    // optionally cleanup compressed buffer if requested
+
+    if (cleanup)    delete[] buffer;
+
+    return newBuffer.release();
+}
+
+
+#else
+
+
+bool canCompress()
+{
+    OPENVDB_LOG_DEBUG("Can't compress array data without the blosc library.");
+    return false;
+}
+
+
+size_t uncompressedSize(const char*)
+{
+    OPENVDB_THROW(RuntimeError, "Can't extract compressed data without the blosc library.");
+}
+
+
+size_t compressedSize(const char*, const size_t, const size_t, const Settings&)
+{
+    OPENVDB_LOG_DEBUG("Can't compress array data without the blosc library.");
+    return 0;
+}
+
+
+char* compress(char*, const size_t, const size_t, size_t&, const bool, const Settings&)
+{
+    OPENVDB_LOG_DEBUG("Can't compress array data without the blosc library.");
+    return 0;
+}
+
+
+char* decompress(char*, const size_t, const bool)
+{
+    OPENVDB_THROW(RuntimeError, "Can't extract compressed data without the blosc library.");
+}
+
+
+bool decompress(const char*, char*, const size_t)
+{
+    OPENVDB_THROW(RuntimeError, "Can't extract compressed data without the blosc library.");
+}
+
+
+#endif // OPENVDB_USE_BLOSC
+
+
+char* compress( const char* buffer, const size_t typeSize,
+                const size_t uncompressedBytes, size_t& compressedBytes,
+                const Settings& settings)
+{
+    return compress(const_cast<char*>(buffer), typeSize, uncompressedBytes, compressedBytes,
+        /*cleanup=*/false, settings);
+}
+
+
+char* decompress(const char* buffer, const size_t expectedBytes)
+{
+    return decompress(const_cast<char*>(buffer), expectedBytes, /*cleanup=*/false);
+}
+
+
+} // namespace attribute_compression
+
+
+////////////////////////////////////////
+
+
+namespace attribute_mapping {
+
+
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+
+
+namespace {
+
+// a read-only mapping of an entire file, this keeps the MappedFile (and therefore any
+// temporary copy of the file) alive for as long as the mapping is in use
+struct MappedRegion
+{
+    explicit MappedRegion(const io::MappedFile::Ptr& file)
+        : mFile(file)
+    {
+        boost::interprocess::file_mapping mapping(file->filename().c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region(mapping, boost::interprocess::read_only).swap(mRegion);
+    }
+
+    io::MappedFile::Ptr mFile;
+    boost::interprocess::mapped_region mRegion;
+};
+
+typedef std::map<const io::MappedFile*, boost::weak_ptr<MappedRegion> > MappedRegionMap;
+
+// Declare this at file scope to ensure thread-safe initialization.
+tbb::spin_mutex sMappedRegionMutex;
+
+// Global map of the regions currently in use (one per file)
+MappedRegionMap&
+getMappedRegions()
+{
+    static MappedRegionMap* regions = NULL;
+
+    if (regions == NULL) {
+
+#ifdef __ICC
+// Disable ICC "assignment to statically allocated variable" warning.
+__pragma(warning(disable:1711))
+#endif
+        // This assignment is mutex-protected (by the caller) and therefore thread-safe.
+        regions = new MappedRegionMap();
+
+#ifdef __ICC
+__pragma(warning(default:1711))
+#endif
+
+    }
+
+    return *regions;
+}
+
+// return the region for this file, mapping the file if it is not already in use
+boost::shared_ptr<MappedRegion>
+getMappedRegion(const io::MappedFile::Ptr& file)
+{
+    boost::shared_ptr<MappedRegion> region;
+
+    {
+        tbb::spin_mutex::scoped_lock lock(sMappedRegionMutex);
+
+        MappedRegionMap& regions = getMappedRegions();
+
+        // discard any regions that are no longer in use
+
+        for (MappedRegionMap::iterator it = regions.begin(); it != regions.end(); ) {
+            if (it->second.expired())   regions.erase(it++);
+            else                        ++it;
+        }
+
+        region = regions[file.get()].lock();
+
+        if (!region) {
+            try {
+                region.reset(new MappedRegion(file));
+            }
+            catch (boost::interprocess::interprocess_exception& e) {
+                OPENVDB_LOG_DEBUG("Unable to map \"" << file->filename() << "\" (" << e.what() << ")");
+                return boost::shared_ptr<MappedRegion>();
+            }
+            regions[file.get()] = region;
+        }
+    }
+
+    return region;
+}
+
+} // unnamed namespace
+
+
+boost::shared_ptr<const char> mapData(const io::MappedFile::Ptr& file, const std::streamoff bufpos, const size_t bytes)
+{
+    if (!file)  return boost::shared_ptr<const char>();
+
+    boost::shared_ptr<MappedRegion> region = getMappedRegion(file);
+
+    if (!region)    return boost::shared_ptr<const char>();
+
+    if (bufpos < 0 || size_t(bufpos) + bytes > region->mRegion.get_size()) {
+        return boost::shared_ptr<const char>();
+    }
+
+    const char* data = static_cast<const char*>(region->mRegion.get_address()) + bufpos;
+
+    // the returned pointer shares ownership of the region
+
+    return boost::shared_ptr<const char>(region, data);
+}
+
+
+void prefetchData(const io::MappedFile::Ptr& file, const std::streamoff bufpos, const size_t bytes)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (!file || bytes == 0)    return;
+
+    boost::shared_ptr<MappedRegion> region = getMappedRegion(file);
+
+    if (!region || bufpos < 0 || size_t(bufpos) + bytes > region->mRegion.get_size())   return;
+
+    // advice must start on a page boundary
+
+    const size_t pageSize = boost::interprocess::mapped_region::get_page_size();
+    const size_t begin = (size_t(bufpos) / pageSize) * pageSize;
+
+    char* address = static_cast<char*>(region->mRegion.get_address()) + begin;
+
+    ::madvise(address, size_t(bufpos) + bytes - begin, MADV_WILLNEED);
+#else
+    (void) file; (void) bufpos; (void) bytes;
+#endif
+}
+
+
+#else
+
+
+boost::shared_ptr<const char> mapData(const io::MappedFile::Ptr&, const std::streamoff, const size_t)
+{
+    return boost::shared_ptr<const char>();
+}
+
+
+void prefetchData(const io::MappedFile::Ptr&, const std::streamoff, const size_t)
+{
+}
+
+
+#endif // OPENVDB_2_ABI_COMPATIBLE
+
+
+} // namespace attribute_mapping
+
+
+////////////////////////////////////////
+
+
+namespace attribute_codec_internal {
+
+
+namespace {
+
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
+
+struct CpuFeatures
+{
+    CpuFeatures() : avx2(false), f16c(false)
+    {
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))    return;
+
+        // AVX requires both CPU support and the operating system to preserve YMM state
+
+        const bool osxsave = (ecx & (1u << 27)) != 0;
+        const bool avx = (ecx & (1u << 28)) != 0;
+        if (!osxsave || !avx)   return;
+
+        unsigned xcr0 = 0, xcr0High = 0;
+        __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+        if ((xcr0 & 0x6) != 0x6)    return;
+
+        f16c = (ecx & (1u << 29)) != 0;
+
+        if (__get_cpuid_max(0, NULL) >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            avx2 = (ebx & (1u << 5)) != 0;
+        }
+    }
+
+    bool avx2;
+    bool f16c;
+};
+
+const CpuFeatures& cpuFeatures()
+{
+    static const CpuFeatures features;
+    return features;
+}
+
+// Each kernel converts whole blocks of values and returns the number converted,
+// the remaining values are converted by the scalar fallback
+
+__attribute__((target("avx,f16c")))
+size_t decodeHalfF16C(const half* data, float* values, const size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm256_storeu_ps(values + i, _mm256_cvtph_ps(in));
+    }
+    return i;
+}
+
+__attribute__((target("avx,f16c")))
+size_t encodeHalfF16C(const float* values, half* data, const size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 in = _mm256_loadu_ps(values + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),
+            _mm256_cvtps_ph(in, _MM_FROUND_TO_NEAREST_INT));
+    }
+    return i;
+}
+
+// fixed-point values are divided (rather than multiplied by a reciprocal) and shifted
+// by one half to exactly match FixedPointCodec::decode()
+
+size_t decodeFixedPointSSE2(const uint8_t* data, float* values, const size_t count)
+{
+    const __m128 scale = _mm_set1_ps(float(std::numeric_limits<uint8_t>::max()));
+    const __m128 shift = _mm_set1_ps(0.5f);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i lo = _mm_unpacklo_epi8(in, zero);
+        const __m128i hi = _mm_unpackhi_epi8(in, zero);
+        const __m128i in32[4] = {   _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                                    _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+        for (int j = 0; j < 4; j++) {
+            const __m128 out = _mm_sub_ps(_mm_div_ps(_mm_cvtepi32_ps(in32[j]), scale), shift);
+            _mm_storeu_ps(values + i + j * 4, out);
+        }
+    }
+    return i;
+}
+
+size_t decodeFixedPointSSE2(const uint16_t* data, float* values, const size_t count)
+{
+    const __m128 scale = _mm_set1_ps(float(std::numeric_limits<uint16_t>::max()));
+    const __m128 shift = _mm_set1_ps(0.5f);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(in, zero));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(in, zero));
+        _mm_storeu_ps(values + i, _mm_sub_ps(_mm_div_ps(lo, scale), shift));
+        _mm_storeu_ps(values + i + 4, _mm_sub_ps(_mm_div_ps(hi, scale), shift));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t decodeFixedPointAVX2(const uint8_t* data, float* values, const size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(float(std::numeric_limits<uint8_t>::max()));
+    const __m256 shift = _mm256_set1_ps(0.5f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i));
+        const __m256 in32 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(in));
+        _mm256_storeu_ps(values + i, _mm256_sub_ps(_mm256_div_ps(in32, scale), shift));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t decodeFixedPointAVX2(const uint16_t* data, float* values, const size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(float(std::numeric_limits<uint16_t>::max()));
+    const __m256 shift = _mm256_set1_ps(0.5f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m256 in32 = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(in));
+        _mm256_storeu_ps(values + i, _mm256_sub_ps(_mm256_div_ps(in32, scale), shift));
+    }
+    return i;
+}
+
+#endif // OPENVDB_POINTS_X86_CODEC_KERNELS
+
+template <typename IntegerT>
+inline void
+decodeFixedPointScalar(const IntegerT* data, float* values, const size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        FixedPointCodec<sizeof(IntegerT) == 1>::decode(data[i], values[i]);
+    }
+}
+
+} // unnamed namespace
+
+
+void
+decodeHalf(const half* data, float* values, const size_t count)
+{
+    size_t i = 0;
+
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
+    if (cpuFeatures().f16c)     i = decodeHalfF16C(data, values, count);
+#endif
+
+    for (; i < count; i++)  values[i] = float(data[i]);
+}
+
+
+void
+encodeHalf(const float* values, half* data, const size_t count)
+{
+    size_t i = 0;
+
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
+    if (cpuFeatures().f16c)     i = encodeHalfF16C(values, data, count);
+#endif
+
+    for (; i < count; i++)  data[i] = half(values[i]);
+}
+
+
+void
+decodeFixedPoint(const uint8_t* data, float* values, const size_t count)
+{
+    size_t i = 0;
+
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
+    if (cpuFeatures().avx2)     i = decodeFixedPointAVX2(data, values, count);
+    else                        i = decodeFixedPointSSE2(data, values, count);
+#endif
+
+    decodeFixedPointScalar(data + i, values + i, count - i);
+}
+
+
+void
+decodeFixedPoint(const uint16_t* data, float* values, const size_t count)
+{
+    size_t i = 0;
+
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
+    if (cpuFeatures().avx2)     i = decodeFixedPointAVX2(data, values, count);
+    else                        i = decodeFixedPointSSE2(data, values, count);
+#endif
+
+    decodeFixedPointScalar(data + i, values + i, count - i);
+}
 
-////////////////////////////////////////
 
-namespace attribute_compression {
+namespace {
 
+// Packed deltas are stored as a header, followed by one entry per block of consecutive
+// values and then the bit-packed, zig-zag encoded differences between successive values
+// of each block. Arithmetic is unsigned so that differences wrap rather than overflow.
 
-#ifdef OPENVDB_USE_BLOSC
+const size_t DELTA_BLOCK_SIZE = 64;
 
+struct DeltaHeader
+{
+    Index64 count;  // number of values
+    Index64 base;   // minimum value
+};
 
-bool canCompress()
+struct DeltaBlock
 {
-    return true;
-}
+    Index64 first;  // first value of the block relative to the base
+    Index32 word;   // index of the first word of the packed differences
+    Index32 bits;   // bits per difference
+};
 
+inline Index64 zigZagEncode(const Index64 delta)
+{
+    return (delta << 1) ^ (Index64(0) - (delta >> 63));
+}
 
-size_t uncompressedSize(const char* buffer)
+inline Index64 zigZagDecode(const Index64 value)
 {
-    size_t bytes, _1, _2;
-    blosc_cbuffer_sizes(buffer, &bytes, &_1, &_2);
-    return bytes;
+    return (value >> 1) ^ (Index64(0) - (value & 1));
 }
 
+inline Index32 bitWidth(Index64 value)
+{
+    Index32 bits = 0;
+    for (; value; value >>= 1)  bits++;
+    return bits;
+}
 
-size_t compressedSize( const char* buffer, const size_t typeSize, const size_t uncompressedBytes)
+template <typename IntegerT>
+char* packDeltasImpl(const IntegerT* values, const size_t count, size_t& packedBytes)
 {
-    size_t tempBytes = uncompressedBytes + BLOSC_MAX_OVERHEAD;
-    const bool outOfRange = tempBytes > BLOSC_MAX_BUFFERSIZE;
-    boost::scoped_array<char> outBuf(outOfRange ? new char[1] : new char[tempBytes]);
+    if (count == 0)     return 0;
 
-    int compressedBytes = blosc_compress_ctx(
-        /*clevel=*/9, // 0 (no compression) to 9 (maximum compression)
-        /*doshuffle=*/true,
-        /*typesize=*/typeSize,
-        /*srcsize=*/uncompressedBytes,
-        /*src=*/buffer,
-        /*dest=*/outBuf.get(),
-        /*destsize=*/tempBytes,
-        BLOSC_LZ4_COMPNAME,
-        /*blocksize=*/256,
-        /*numthreads=*/1);
+    // values are offset from the minimum, reinterpreted as unsigned
 
-    if (compressedBytes <= 0) {
-        std::ostringstream ostr;
-        ostr << "Blosc failed to compress " << uncompressedBytes << " byte" << (uncompressedBytes == 1 ? "" : "s");
-        if (compressedBytes < 0) ostr << " (internal error " << compressedBytes << ")";
-        OPENVDB_LOG_DEBUG(ostr.str());
-        return 0;
-    }
+    const Index64 base = Index64(*std::min_element(values, values + count));
 
-    return size_t(compressedBytes);
-}
+    const size_t blockCount = (count + DELTA_BLOCK_SIZE - 1) / DELTA_BLOCK_SIZE;
+    std::vector<DeltaBlock> blocks(blockCount);
 
+    size_t words = 0;
 
-char* compress( char* buffer, const size_t typeSize,
-                const size_t uncompressedBytes, size_t& compressedBytes, const bool cleanup)
-{
-    size_t tempBytes = uncompressedBytes + BLOSC_MAX_OVERHEAD;
-    const bool outOfRange = tempBytes > BLOSC_MAX_BUFFERSIZE;
-    boost::scoped_array<char> outBuf(outOfRange ? new char[1] : new char[tempBytes]);
-
-    int _compressedBytes = blosc_compress_ctx(
-        /*clevel=*/9, // 0 (no compression) to 9 (maximum compression)
-        /*doshuffle=*/true,
-        /*typesize=*/typeSize,
-        /*srcsize=*/uncompressedBytes,
-        /*src=*/buffer,
-        /*dest=*/outBuf.get(),
-        /*destsize=*/tempBytes,
-        BLOSC_LZ4_COMPNAME,
-        /*blocksize=*/256,
-        /*numthreads=*/1);
-
-    if (_compressedBytes <= 0) {
-        std::ostringstream ostr;
-        ostr << "Blosc failed to compress " << uncompressedBytes << " byte" << (uncompressedBytes == 1 ? "" : "s");
-        if (_compressedBytes < 0) ostr << " (internal error " << _compressedBytes << ")";
-        OPENVDB_LOG_DEBUG(ostr.str());
-        return 0;
+    for (size_t b = 0; b < blockCount; b++) {
+        const size_t start = b * DELTA_BLOCK_SIZE;
+        const size_t end = std::min(start + DELTA_BLOCK_SIZE, count);
+
+        Index64 maxDelta = 0;
+        for (size_t i = start + 1; i < end; i++) {
+            maxDelta |= zigZagEncode(Index64(values[i]) - Index64(values[i - 1]));
+        }
+
+        DeltaBlock& block = blocks[b];
+        block.first = Index64(values[start]) - base;
+        block.word = Index32(words);
+        block.bits = bitWidth(maxDelta);
+
+        words += ((end - start - 1) * block.bits + 63) / 64;
     }
 
-    // optionally cleanup compressed buffer if requested (prior to allocating new uncompressed buffer)
+    packedBytes = sizeof(DeltaHeader) + blockCount * sizeof(DeltaBlock) + words * sizeof(Index64);
 
-    if (cleanup)    delete[] buffer;
+    // only pack if this reduces the size of the data
 
-    compressedBytes = size_t(_compressedBytes);
+    if (packedBytes >= count * sizeof(IntegerT))    return 0;
 
-    char* outData = new char[compressedBytes];
-    std::memcpy(outData, outBuf.get(), compressedBytes);
-    return outData;
-}
+    char* buffer = new char[packedBytes];
+    std::memset(buffer, 0, packedBytes);
 
+    DeltaHeader* header = reinterpret_cast<DeltaHeader*>(buffer);
+    header->count = Index64(count);
+    header->base = base;
 
-char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup)
-{
-    size_t tempBytes = expectedBytes + BLOSC_MAX_OVERHEAD;
-    const bool outOfRange = tempBytes > BLOSC_MAX_BUFFERSIZE;
-    if (outOfRange)     tempBytes = 1;
-    boost::scoped_array<char> tempBuffer(new char[tempBytes]);
+    std::memcpy(buffer + sizeof(DeltaHeader), &blocks[0], blockCount * sizeof(DeltaBlock));
 
-    const int _uncompressedBytes = blosc_decompress_ctx(  /*src=*/buffer,
-                                                            /*dest=*/tempBuffer.get(),
-                                                            tempBytes,
-                                                            /*numthreads=*/1);
+    Index64* data = reinterpret_cast<Index64*>(
+        buffer + sizeof(DeltaHeader) + blockCount * sizeof(DeltaBlock));
 
-    if (_uncompressedBytes < 1) {
-        OPENVDB_LOG_DEBUG("blosc_decompress() returned error code " << _uncompressedBytes);
-        return 0;
+    for (size_t b = 0; b < blockCount; b++) {
+        const DeltaBlock& block = blocks[b];
+        if (block.bits == 0)    continue;
+
+        const size_t start = b * DELTA_BLOCK_SIZE;
+        const size_t end = std::min(start + DELTA_BLOCK_SIZE, count);
+
+        Index64* blockData = data + block.word;
+        size_t bit = 0;
+
+        for (size_t i = start + 1; i < end; i++, bit += block.bits) {
+            const Index64 value = zigZagEncode(Index64(values[i]) - Index64(values[i - 1]));
+            const size_t word = bit >> 6, shift = bit & 63;
+            blockData[word] |= value << shift;
+            if (shift + block.bits > 64)    blockData[word + 1] |= value >> (64 - shift);
+        }
     }
 
-    size_t uncompressedBytes = size_t(_uncompressedBytes);
+    return buffer;
+}
 
-    if (uncompressedBytes != expectedBytes) {
-        OPENVDB_THROW(RuntimeError, "Expected to decompress " << expectedBytes
-            << " byte" << (expectedBytes == 1 ? "" : "s") << ", got "
-            << uncompressedBytes << " byte" << (uncompressedBytes == 1 ? "" : "s"));
+template <typename IntegerT>
+void unpackDeltasImpl(const char* buffer, const Index n, const size_t count, IntegerT* values)
+{
+    const DeltaHeader* header = reinterpret_cast<const DeltaHeader*>(buffer);
+    assert(n + count <= header->count);
+
+    const size_t blockCount = (size_t(header->count) + DELTA_BLOCK_SIZE - 1) / DELTA_BLOCK_SIZE;
+    const DeltaBlock* blocks = reinterpret_cast<const DeltaBlock*>(buffer + sizeof(DeltaHeader));
+    const Index64* data = reinterpret_cast<const Index64*>(
+        buffer + sizeof(DeltaHeader) + blockCount * sizeof(DeltaBlock));
+
+    size_t i = n;
+    const size_t end = n + count;
+
+    while (i < end) {
+
+        // accumulate differences from the start of the block containing index i
+
+        const size_t b = i / DELTA_BLOCK_SIZE;
+        const DeltaBlock& block = blocks[b];
+        const size_t blockStart = b * DELTA_BLOCK_SIZE;
+        const size_t blockEnd = std::min(blockStart + DELTA_BLOCK_SIZE, end);
+
+        const Index64* blockData = data + block.word;
+        const Index64 mask = block.bits == 64 ? ~Index64(0) : (Index64(1) << block.bits) - 1;
+
+        Index64 value = header->base + block.first;
+        size_t bit = 0;
+
+        for (size_t j = blockStart; j < blockEnd; j++) {
+            if (j > blockStart && block.bits > 0) {
+                const size_t word = bit >> 6, shift = bit & 63;
+                Index64 delta = blockData[word] >> shift;
+                if (shift + block.bits > 64)    delta |= blockData[word + 1] << (64 - shift);
+                value += zigZagDecode(delta & mask);
+                bit += block.bits;
+            }
+            if (j >= i)     *values++ = IntegerT(value);
+        }
+
+        i = blockEnd;
     }
+}
 
-    // optionally cleanup compressed buffer if requested (prior to allocating new uncompressed buffer)
+} // unnamed namespace
 
-    if (cleanup)    delete[] buffer;
 
-    char* newBuffer = new char[uncompressedBytes];
-    std::memcpy(newBuffer, tempBuffer.get(), uncompressedBytes);
+char*
+packDeltas(const int32_t* values, const size_t count, size_t& packedBytes)
+{
+    return packDeltasImpl(values, count, packedBytes);
+}
+
 
-    return newBuffer;
+char*
+packDeltas(const int64_t* values, const size_t count, size_t& packedBytes)
+{
+    return packDeltasImpl(values, count, packedBytes);
 }
 
 
-#else
+void
+unpackDeltas(const char* buffer, const Index n, const size_t count, int32_t* values)
+{
+    unpackDeltasImpl(buffer, n, count, values);
+}
 
 
-bool canCompress()
+void
+unpackDeltas(const char* buffer, const Index n, const size_t count, int64_t* values)
 {
-    OPENVDB_LOG_DEBUG("Can't compress array data without the blosc library.");
-    return false;
+    unpackDeltasImpl(buffer, n, count, values);
 }
 
 
-size_t uncompressedSize(const char*)
+namespace {
+
+// Quantized positions are stored as a header followed by a bit stream of one record per
+// position, each record holding the quantized axes of the position. Every axis has its own
+// minimum, step and bit depth, so axes that do not vary use no bits at all.
+
+const Index32 QUANTIZED_MAX_BITS = 21;
+
+struct QuantizedHeader
 {
-    OPENVDB_THROW(RuntimeError, "Can't extract compressed data without the blosc library.");
+    Index64 count;      // number of positions
+    float minimum[3];   // minimum value of each axis
+    float step[3];      // quantization step of each axis
+    Index32 bits[3];    // bits per axis
+    Index32 recordBits; // bits per position
+};
+
+inline float dequantize(const Index32 value, const float minimum, const float step)
+{
+    const float offset = float(value) * step;
+    return minimum + offset;
 }
 
+inline Index32 quantize(const float value, const float minimum, const float step, const Index32 bits)
+{
+    if (bits == 0)  return 0;
+    const double level = std::floor(double(value - minimum) / double(step) + 0.5);
+    const double maxLevel = double((Index64(1) << bits) - 1);
+    return Index32(std::min(std::max(level, 0.0), maxLevel));
+}
 
-size_t compressedSize(const char*, const size_t, const size_t)
+inline Index64 readRecord(const Index64* data, const Index64 bit, const Index32 bits)
 {
-    OPENVDB_LOG_DEBUG("Can't compress array data without the blosc library.");
-    return 0;
+    const size_t word = size_t(bit >> 6), shift = size_t(bit & 63);
+    Index64 record = data[word] >> shift;
+    if (shift + bits > 64)  record |= data[word + 1] << (64 - shift);
+    return bits == 64 ? record : record & ((Index64(1) << bits) - 1);
 }
 
+// Return the fewest bits that keep every value of an axis within the tolerance
 
-char* compress(char*, const size_t, const size_t, size_t&, const bool)
+Index32 quantizedBits(const math::Vec3<float>* values, const size_t count, const int axis,
+    const float minimum, const float maximum, const float tolerance, float& step)
 {
-    OPENVDB_LOG_DEBUG("Can't compress array data without the blosc library.");
-    return 0;
+    step = 0.0f;
+    if (!(maximum > minimum))   return 0;
+
+    // the quantization error is at most half a step, start from the fewest bits for which
+    // this is within the tolerance and add bits until rounding errors are also accounted for
+
+    const double levels = double(maximum - minimum) / (2.0 * double(tolerance));
+    Index32 bits = Index32(std::max(std::ceil(std::log(levels + 1.0) / std::log(2.0)), 1.0));
+
+    for (; bits <= QUANTIZED_MAX_BITS; bits++) {
+        step = float(double(maximum - minimum) / double((Index64(1) << bits) - 1));
+        if (!(step > 0.0f))     continue;
+
+        bool valid = true;
+        for (size_t i = 0; i < count && valid; i++) {
+            const float value = values[i][axis];
+            const float result = dequantize(quantize(value, minimum, step, bits), minimum, step);
+            valid = std::abs(result - value) <= tolerance;
+        }
+        if (valid)  return bits;
+    }
+
+    return QUANTIZED_MAX_BITS + 1;
 }
 
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
 
-char* decompress(char*, const size_t, const bool)
+// quantized axes of four positions are dequantized per iteration, the minimum and step of
+// each axis repeat every three lanes so are held in three rotated registers
+
+size_t dequantizeSSE2(const Index32* data, const float* minimum, const float* step,
+    float* values, const size_t count)
 {
-    OPENVDB_THROW(RuntimeError, "Can't extract compressed data without the blosc library.");
+    const __m128 minimum0 = _mm_setr_ps(minimum[0], minimum[1], minimum[2], minimum[0]);
+    const __m128 minimum1 = _mm_setr_ps(minimum[1], minimum[2], minimum[0], minimum[1]);
+    const __m128 minimum2 = _mm_setr_ps(minimum[2], minimum[0], minimum[1], minimum[2]);
+    const __m128 step0 = _mm_setr_ps(step[0], step[1], step[2], step[0]);
+    const __m128 step1 = _mm_setr_ps(step[1], step[2], step[0], step[1]);
+    const __m128 step2 = _mm_setr_ps(step[2], step[0], step[1], step[2]);
+
+    size_t i = 0;
+    for (; i + 12 <= count; i += 12) {
+        const __m128 in0 = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        const __m128 in1 = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4)));
+        const __m128 in2 = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 8)));
+        _mm_storeu_ps(values + i, _mm_add_ps(minimum0, _mm_mul_ps(in0, step0)));
+        _mm_storeu_ps(values + i + 4, _mm_add_ps(minimum1, _mm_mul_ps(in1, step1)));
+        _mm_storeu_ps(values + i + 8, _mm_add_ps(minimum2, _mm_mul_ps(in2, step2)));
+    }
+    return i;
 }
 
+#endif // OPENVDB_POINTS_X86_CODEC_KERNELS
 
-#endif // OPENVDB_USE_BLOSC
+} // unnamed namespace
 
 
-char* compress( const char* buffer, const size_t typeSize,
-                const size_t uncompressedBytes, size_t& compressedBytes)
+char*
+packQuantized(const math::Vec3<float>* values, const size_t count,
+              const float tolerance, size_t& packedBytes)
 {
-    return compress(const_cast<char*>(buffer), typeSize, uncompressedBytes, compressedBytes, /*cleanup=*/false);
+    if (count == 0 || !(tolerance > 0.0f))  return 0;
+
+    QuantizedHeader header;
+    header.count = Index64(count);
+    header.recordBits = 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float minimum = values[0][axis], maximum = values[0][axis];
+        for (size_t i = 1; i < count; i++) {
+            minimum = std::min(minimum, values[i][axis]);
+            maximum = std::max(maximum, values[i][axis]);
+        }
+
+        // non-finite values cannot be quantized
+
+        if (!std::isfinite(minimum) || !std::isfinite(maximum))     return 0;
+
+        header.minimum[axis] = minimum;
+        header.bits[axis] = quantizedBits(values, count, axis, minimum, maximum,
+                                          tolerance, header.step[axis]);
+        if (header.bits[axis] > QUANTIZED_MAX_BITS)     return 0;
+        header.recordBits += header.bits[axis];
+    }
+
+    const size_t words = (count * header.recordBits + 63) / 64;
+
+    packedBytes = sizeof(QuantizedHeader) + words * sizeof(Index64);
+
+    // only pack if this reduces the size of the data
+
+    if (packedBytes >= count * sizeof(math::Vec3<float>))   return 0;
+
+    char* buffer = new char[packedBytes];
+    std::memset(buffer, 0, packedBytes);
+    std::memcpy(buffer, &header, sizeof(QuantizedHeader));
+
+    Index64* data = reinterpret_cast<Index64*>(buffer + sizeof(QuantizedHeader));
+
+    Index64 bit = 0;
+
+    for (size_t i = 0; i < count; i++, bit += header.recordBits) {
+        Index64 record = 0;
+        Index32 offset = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            const Index32 bits = header.bits[axis];
+            record |= Index64(quantize(values[i][axis], header.minimum[axis],
+                                       header.step[axis], bits)) << offset;
+            offset += bits;
+        }
+
+        if (header.recordBits == 0)     continue;
+
+        const size_t word = size_t(bit >> 6), shift = size_t(bit & 63);
+        data[word] |= record << shift;
+        if (shift + header.recordBits > 64)   data[word + 1] |= record >> (64 - shift);
+    }
+
+    return buffer;
 }
 
 
-char* decompress(const char* buffer, const size_t expectedBytes)
+void
+unpackQuantized(const char* buffer, const Index n, const size_t count, math::Vec3<float>* values)
 {
-    return decompress(const_cast<char*>(buffer), expectedBytes, /*cleanup=*/false);
+    QuantizedHeader header;
+    std::memcpy(&header, buffer, sizeof(QuantizedHeader));
+    assert(n + count <= header.count);
+
+    const Index64* data = reinterpret_cast<const Index64*>(buffer + sizeof(QuantizedHeader));
+
+    const Index32 masks[3] = {  Index32((Index64(1) << header.bits[0]) - 1),
+                                Index32((Index64(1) << header.bits[1]) - 1),
+                                Index32((Index64(1) << header.bits[2]) - 1) };
+
+    // positions are extracted from the bit stream in batches and then dequantized
+
+    const size_t batchSize = 256;
+    Index32 levels[batchSize * 3];
+
+    for (size_t start = 0; start < count; start += batchSize) {
+        const size_t batch = std::min(batchSize, count - start);
+
+        Index64 bit = Index64(n + start) * header.recordBits;
+
+        for (size_t i = 0; i < batch; i++, bit += header.recordBits) {
+            const Index64 record = header.recordBits ? readRecord(data, bit, header.recordBits) : 0;
+            levels[i * 3] = Index32(record) & masks[0];
+            levels[i * 3 + 1] = Index32(record >> header.bits[0]) & masks[1];
+            levels[i * 3 + 2] = Index32(record >> (header.bits[0] + header.bits[1])) & masks[2];
+        }
+
+        float* out = reinterpret_cast<float*>(values + start);
+        size_t i = 0;
+
+#ifdef OPENVDB_POINTS_X86_CODEC_KERNELS
+        i = dequantizeSSE2(levels, header.minimum, header.step, out, batch * 3);
+#endif
+
+        for (; i < batch * 3; i++) {
+            out[i] = dequantize(levels[i], header.minimum[i % 3], header.step[i % 3]);
+        }
+    }
 }
 
 
-} // namespace attribute_compression
+} // namespace attribute_codec_internal
 
 
 ////////////////////////////////////////
@@ -272,6 +1234,54 @@ __pragma(warning(default:1711))
     return registry;
 }
 
+// Global toggle for accessing uncompressed array data directly from a memory-mapped file
+// (zero-initialized as it has static storage duration)
+tbb::atomic<bool> sMapUncompressedData;
+
+// Global epoch used to stamp arrays as they are loaded or accessed, this only advances when an
+// array is loaded so that binding handles in parallel loops doesn't contend on the counter
+// (zero-initialized as it has static storage duration)
+tbb::atomic<Index64> sAccessEpoch;
+
+// Global toggle for reusing recent decompressions in read-only handles
+// (zero-initialized as it has static storage duration, so the cache is enabled by default)
+tbb::atomic<bool> sDecompressionCacheDisabled;
+
+// maximum bytes and number of decompressed arrays retained by each thread,
+// decompressed arrays larger than the budget are not retained
+const size_t sDecompressionCacheBytes = size_t(16) << 20;
+const size_t sDecompressionCacheEntries = 8;
+
+struct DecompressedArray
+{
+    DecompressedArray(const boost::weak_ptr<void>& stamp_, const AttributeArray::Ptr& copy_,
+                      const size_t bytes_)
+        : stamp(stamp_), copy(copy_), bytes(bytes_) { }
+
+    boost::weak_ptr<void> stamp;
+    AttributeArray::Ptr copy;
+    size_t bytes;
+};
+
+// decompressed arrays, ordered from least to most recently used
+struct DecompressionCache
+{
+    DecompressionCache() : bytes(0) { }
+
+    void erase(std::vector<DecompressedArray>::iterator it)
+    {
+        bytes -= it->bytes;
+        entries.erase(it);
+    }
+
+    std::vector<DecompressedArray> entries;
+    size_t bytes;
+};
+
+typedef tbb::enumerable_thread_specific<DecompressionCache> DecompressionCaches;
+
+DecompressionCaches sDecompressionCaches;
+
 } // unnamed namespace
 
 
@@ -366,6 +1376,179 @@ AttributeArray::setHidden(bool state)
 }
 
 
+void
+AttributeArray::setMapUncompressedData(bool state)
+{
+    sMapUncompressedData = state;
+}
+
+
+bool
+AttributeArray::mapUncompressedData()
+{
+    return sMapUncompressedData;
+}
+
+
+void
+AttributeArray::setCompressionSettings(const attribute_compression::Settings& settings)
+{
+    using attribute_compression::Settings;
+
+    if (settings.compressor > Settings::ZSTD) {
+        OPENVDB_THROW(ValueError, "Invalid Blosc compressor - " << int(settings.compressor) << ".");
+    }
+    if (settings.level > 9) {
+        OPENVDB_THROW(ValueError, "Invalid Blosc compression level - " << int(settings.level) << ".");
+    }
+    if (settings.shuffle > Settings::BITSHUFFLE) {
+        OPENVDB_THROW(ValueError, "Invalid Blosc shuffle - " << int(settings.shuffle) << ".");
+    }
+    if (!(settings.tolerance >= 0.0f)) {
+        OPENVDB_THROW(ValueError, "Invalid compression tolerance - " << settings.tolerance << ".");
+    }
+
+    mCompressionSettings = settings;
+}
+
+
+void
+AttributeArray::prefetchData() const
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    if (!(mFlags & OUTOFCORE) || !mFileInfo)  return;
+
+    attribute_mapping::prefetchData(mFileInfo->mapping, mFileInfo->bufpos, size_t(mFileInfo->bytes));
+#endif
+}
+
+
+bool
+AttributeArray::isReleasable() const
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    return !(mFlags & OUTOFCORE) && mFileInfo;
+#else
+    return false;
+#endif
+}
+
+
+Index64
+AttributeArray::accessStamp() const
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    return mAccessStamp;
+#else
+    return 0;
+#endif
+}
+
+
+void
+AttributeArray::touch() const
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    // accesses are stamped after the most recent load (and so never zero), the stamp is
+    // only written when it changes to avoid contending on the cache line
+
+    const Index64 stamp = sAccessEpoch + 1;
+    if (mAccessStamp != stamp)  mAccessStamp = stamp;
+#endif
+}
+
+
+void
+AttributeArray::touchLoaded() const
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    mAccessStamp = ++sAccessEpoch;
+#endif
+}
+
+
+struct AttributeArray::CompressedStamp { };
+
+
+void
+AttributeArray::stampCompressedData()
+{
+    mCompressedStamp.reset(new CompressedStamp);
+}
+
+
+AttributeArray::Ptr
+AttributeArray::cachedCopyUncompressed() const
+{
+    // cached copies are matched by the stamp of the compressed data rather than the array,
+    // stamps are unique while referenced so a copy cannot match different data
+
+    const boost::shared_ptr<CompressedStamp> stamp = mCompressedStamp;
+
+    if (sDecompressionCacheDisabled || !this->isCompressed() || !stamp) {
+        return this->copyUncompressed();
+    }
+
+    DecompressionCache& cache = sDecompressionCaches.local();
+    std::vector<DecompressedArray>& entries = cache.entries;
+
+    for (size_t i = 0; i < entries.size(); ) {
+        const boost::shared_ptr<void> entryStamp = entries[i].stamp.lock();
+        if (!entryStamp) {
+            // evict copies of compressed data that no longer exists
+            cache.erase(entries.begin() + i);
+            continue;
+        }
+        if (entryStamp == stamp) {
+            // mark as the most recently used
+            std::rotate(entries.begin() + i, entries.begin() + i + 1, entries.end());
+            return entries.back().copy;
+        }
+        ++i;
+    }
+
+    AttributeArray::Ptr copy = this->copyUncompressed();
+
+    // do not retain the copy if decompression failed or it exceeds the budget
+
+    if (copy->isCompressed())   return copy;
+
+    const size_t bytes = copy->memUsage();
+    if (bytes > sDecompressionCacheBytes)   return copy;
+
+    while (!entries.empty() && (entries.size() >= sDecompressionCacheEntries ||
+                                cache.bytes + bytes > sDecompressionCacheBytes)) {
+        cache.erase(entries.begin());
+    }
+
+    entries.push_back(DecompressedArray(boost::weak_ptr<void>(stamp), copy, bytes));
+    cache.bytes += bytes;
+
+    return copy;
+}
+
+
+void
+AttributeArray::setDecompressionCache(bool state)
+{
+    sDecompressionCacheDisabled = !state;
+}
+
+
+bool
+AttributeArray::decompressionCache()
+{
+    return !sDecompressionCacheDisabled;
+}
+
+
+void
+AttributeArray::clearDecompressionCache()
+{
+    sDecompressionCaches.clear();
+}
+
+
 bool
 AttributeArray::operator==(const AttributeArray& other) const {
     if(this->mCompressedBytes != other.mCompressedBytes ||
@@ -51,9 +51,20 @@
 #include <tbb/spin_mutex.h>
 #include <tbb/atomic.h>
 
+#include <boost/mpl/deref.hpp>
+#include <boost/mpl/begin_end.hpp>
+#include <boost/mpl/next.hpp>
+#include <boost/mpl/vector.hpp>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/is_integral.hpp>
 
+#include <algorithm> // std::fill, std::lower_bound
+#include <cstring> // std::memcpy
 #include <string>
+#include <vector>
 
 
 class TestAttributeArray;
@@ -68,6 +79,8 @@ typedef std::pair<Name, Name> NamePair;
 
 namespace tools {
 
+class GroupHandle;
+
 
 ////////////////////////////////////////
 
@@ -76,9 +89,71 @@ namespace tools {
 
 namespace attribute_compression {
 
+/// @brief Blosc compression settings, and the error tolerance of codecs that quantize
+/// values when compressing them in-memory (see QuantizedPositionCodec)
+struct Settings
+{
+    enum Compressor { BLOSCLZ = 0, LZ4, LZ4HC, SNAPPY, ZLIB, ZSTD };
+    enum Shuffle { NOSHUFFLE = 0, SHUFFLE, BITSHUFFLE };
+
+    explicit Settings(  Compressor compressorType = LZ4, int compressionLevel = 9,
+                        Shuffle shuffleType = SHUFFLE, Index32 blockBytes = 256,
+                        float maximumError = 0.0f)
+        : compressor(uint8_t(compressorType))
+        , level(uint8_t(compressionLevel))
+        , shuffle(uint8_t(shuffleType))
+        , blockSize(blockBytes)
+        , tolerance(maximumError) { }
+
+    /// Return the Blosc name of the compressor
+    const char* compressorName() const;
+
+    bool operator==(const Settings& rhs) const {
+        return compressor == rhs.compressor && level == rhs.level &&
+               shuffle == rhs.shuffle && blockSize == rhs.blockSize &&
+               tolerance == rhs.tolerance;
+    }
+    bool operator!=(const Settings& rhs) const { return !this->operator==(rhs); }
+
+    uint8_t compressor; ///< compression algorithm (Compressor)
+    uint8_t level;      ///< 0 (no compression) to 9 (maximum compression)
+    uint8_t shuffle;    ///< byte or bit shuffle applied prior to compression (Shuffle)
+    Index32 blockSize;  ///< block size in bytes (zero to let Blosc choose)
+    float tolerance;    ///< maximum quantization error in the units of the stored values
+}; // struct Settings
+
 /// @brief Returns true if compression is available
 bool canCompress();
 
+/// @brief Set the maximum number of threads used to compress or decompress a single buffer.
+///
+/// @param threads the maximum number of threads (zero for the number of hardware threads)
+///
+/// @note Additional threads are only used within a ScopedThreads and only for large buffers
+/// (of at least a few megabytes).
+void setMaxThreads(const int threads);
+
+/// @brief Returns the maximum number of threads used to compress or decompress a single buffer.
+int maxThreads();
+
+/// @brief Allows large buffers compressed or decompressed by the calling thread to use
+/// multiple threads for the lifetime of this object.
+///
+/// @details Compression is single-threaded by default, as buffers are usually compressed
+/// within parallel loops (such as over leaf nodes). Serial code that compresses or
+/// decompresses large arrays can opt in to multi-threading with this scope. Only one
+/// multi-threaded call is made at a time, any other calls remain single-threaded.
+class ScopedThreads
+{
+public:
+    ScopedThreads();
+    ~ScopedThreads();
+
+private:
+    ScopedThreads(const ScopedThreads&);
+    ScopedThreads& operator=(const ScopedThreads&);
+}; // class ScopedThreads
+
 /// @brief Retrieves the uncompressed size of buffer when uncompressed
 ///
 /// @param buffer the compressed buffer
@@ -89,7 +164,9 @@ size_t uncompressedSize(const char* buffer);
 /// @param buffer the uncompressed buffer
 /// @param typeSize the size of the data type
 /// @param uncompressedBytes number of uncompressed bytes
-size_t compressedSize(const char* buffer, const size_t typeSize, const size_t uncompressedBytes);
+/// @param settings the compression settings
+size_t compressedSize(const char* buffer, const size_t typeSize, const size_t uncompressedBytes,
+                      const Settings& settings = Settings());
 
 /// @brief Compress and return the compressed buffer.
 ///
@@ -98,9 +175,10 @@ size_t compressedSize(const char* buffer, const size_t typeSize, const size_t un
 /// @param uncompressedBytes number of uncompressed bytes
 /// @param compressedBytes number of compressed bytes (written to this variable)
 /// @param cleanup if true, the supplied buffer will be deleted prior to allocating new memory
+/// @param settings the compression settings
 char* compress( char* buffer, const size_t typeSize,
                 const size_t uncompressedBytes, size_t& compressedBytes,
-                const bool cleanup = false);
+                const bool cleanup = false, const Settings& settings = Settings());
 
 /// @brief Compress and return the compressed buffer.
 ///
@@ -108,10 +186,12 @@ char* compress( char* buffer, const size_t typeSize,
 /// @param typeSize the size of the data type
 /// @param uncompressedBytes number of uncompressed bytes
 /// @param compressedBytes number of compressed bytes (written to this variable)
+/// @param settings the compression settings
 ///
 /// @note Unlike the non-const buffer version, the buffer will never be deleted.
 char* compress( const char* buffer, const size_t typeSize,
-                const size_t uncompressedBytes, size_t& compressedBytes);
+                const size_t uncompressedBytes, size_t& compressedBytes,
+                const Settings& settings = Settings());
 
 /// @brief Decompress and return the uncompressed buffer.
 ///
@@ -128,9 +208,49 @@ char* decompress(char* buffer, const size_t expectedBytes, const bool cleanup =
 /// @note Unlike the non-const buffer version, the buffer will never be deleted.
 char* decompress(const char* buffer, const size_t expectedBytes);
 
+/// @brief Decompress into a caller-provided buffer and return true on success.
+///
+/// @param buffer the buffer to decompress
+/// @param outBuffer the buffer to decompress into (at least @a expectedBytes in size)
+/// @param expectedBytes the number of bytes expected once the buffer is decompressed
+///
+/// @note This avoids any intermediate allocation or copy, the buffer will never be deleted.
+bool decompress(const char* buffer, char* outBuffer, const size_t expectedBytes);
+
 } // namespace attribute_compression
 
 
+////////////////////////////////////////
+
+// Attribute Mapping methods
+
+
+namespace attribute_mapping {
+
+/// @brief Return a read-only pointer to data within a memory-mapped file or a null pointer
+/// if the data cannot be mapped.
+///
+/// @param file the memory-mapped file
+/// @param bufpos the offset of the data from the start of the file
+/// @param bytes the number of bytes of data
+///
+/// @note The file remains mapped for as long as any returned pointer is in use.
+boost::shared_ptr<const char> mapData(const io::MappedFile::Ptr& file,
+                                      const std::streamoff bufpos, const size_t bytes);
+
+/// @brief Advise the operating system that data within a memory-mapped file will be
+/// needed soon, so that it can be read ahead asynchronously.
+///
+/// @param file the memory-mapped file
+/// @param bufpos the offset of the data from the start of the file
+/// @param bytes the number of bytes of data
+///
+/// @note This is only a hint and does nothing on platforms that do not support it.
+void prefetchData(const io::MappedFile::Ptr& file, const std::streamoff bufpos, const size_t bytes);
+
+} // namespace attribute_mapping
+
+
 ////////////////////////////////////////
 
 // Utility methods
@@ -201,9 +321,11 @@ public:
 #ifndef OPENVDB_2_ABI_COMPATIBLE
     struct FileInfo
     {
-        FileInfo(): bufpos(0), bytes(0) {}
+        FileInfo(): bufpos(0), bytes(0), compressed(false), memCompressed(false) {}
         std::streamoff bufpos;
         Index64 bytes;
+        bool compressed;    ///< compressed on-disk
+        bool memCompressed; ///< compressed in-memory, the buffer is the compressed data
         io::MappedFile::Ptr mapping;
         boost::shared_ptr<io::StreamMetadata> meta;
     };
@@ -215,8 +337,14 @@ public:
     typedef Ptr (*FactoryMethod)(size_t, Index);
 
     template <typename ValueType, typename CodecType, bool Strided, bool Interleaved> friend class AttributeHandle;
+    friend class GroupHandle;
 
-    AttributeArray() : mCompressedBytes(0), mFlags(0) {}
+    AttributeArray() : mCompressedBytes(0), mFlags(0), mCompressionSettings()
+    {
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+        mAccessStamp = 0;
+#endif
+    }
     virtual ~AttributeArray() {}
 
     /// Return a copy of this attribute.
@@ -271,11 +399,19 @@ public:
     virtual void expand(bool fill = true) = 0;
     /// Replace the existing array with a uniform zero value.
     virtual void collapse() = 0;
-    /// Compact the existing array to become uniform if all values are identical
+    /// @brief Compact the existing array to become uniform if all values are identical,
+    ///        or sparse if most values are identical.
+    /// @return @c true if the array is uniform.
     virtual bool compact() = 0;
+    /// @brief Return @c true if this array is stored as a default value and a sorted list of
+    ///        the indices and values of elements that differ from it (see compact()).
+    virtual bool isSparse() const { return false; }
 
     /// Return @c true if this array is compressed.
     bool isCompressed() const { return mCompressedBytes != 0; }
+    /// @brief Return @c true if values can be read from this array while it is compressed,
+    ///        so read-only handles do not need to decompress it (see DeltaPackCodec).
+    virtual bool isCompressedReadable() const { return false; }
     /// Compress the attribute array.
     virtual bool compress() = 0;
     /// Uncompress the attribute array.
@@ -299,6 +435,13 @@ public:
     /// @brief Retrieve the attribute array flags
     uint16_t flags() const { return mFlags; }
 
+    /// @brief Specify the Blosc settings used when compressing this array, both in-memory
+    ///        and when writing to a stream with Blosc compression enabled.
+    /// @note  Settings are not serialized, arrays read from a stream use the default settings.
+    void setCompressionSettings(const attribute_compression::Settings& settings);
+    /// Return the Blosc settings used when compressing this array.
+    const attribute_compression::Settings& compressionSettings() const { return mCompressionSettings; }
+
     /// Read attribute metadata and buffers from a stream.
     virtual void read(std::istream&) = 0;
     /// Write attribute metadata and buffers to a stream.
@@ -307,6 +450,49 @@ public:
 
     /// Ensures all data is in-core
     virtual void loadData() const = 0;
+    /// @brief Ensures all data is in-core and owned by this array, copying any data that is
+    ///        accessed directly from a memory-mapped file so that it can be modified.
+    virtual void loadWritableData() = 0;
+    /// @brief Advise the operating system that delay-loaded data will be needed soon.
+    /// @note  This does not load the data, it is only a hint to read the data ahead.
+    void prefetchData() const;
+    /// @brief Free the in-memory data of an unmodified, delay-loaded array and return it
+    ///        to the out-of-core state, the data is read from the file again when next accessed.
+    /// @return @c false if the array could not be released (see isReleasable()).
+    /// @note  Not thread-safe, the array must not be accessed while it is being released.
+    virtual bool releaseData() = 0;
+    /// @brief Return @c true if this array was delay-loaded from a memory-mapped file that it
+    ///        still references and has not been modified since.
+    /// @note  Any write access through set() or a write handle, or a change to the uniform
+    ///        state of the array, detaches it from the file.
+    bool isReleasable() const;
+    /// @brief Return the stamp of the most recent load of, or handle access to, this array.
+    /// @details Stamps are taken from a global epoch that advances each time an array is
+    ///          loaded, so the stamps of two arrays can be compared to find the least recently
+    ///          used. Arrays accessed between the same two loads share a stamp.
+    Index64 accessStamp() const;
+
+    /// @brief Specify whether the uncompressed data of delay-loaded arrays should be accessed
+    ///        directly from the memory-mapped file instead of being copied into memory on load.
+    /// @note  Mapped data is read-only and is copied on the first write to the array.
+    /// @note  Disabled by default.
+    static void setMapUncompressedData(bool state);
+    /// Return @c true if uncompressed, delay-loaded array data is memory-mapped on load.
+    static bool mapUncompressedData();
+
+    /// @brief Globally enable or disable reuse of recently decompressed arrays by
+    ///        read-only AttributeHandles bound to compressed arrays.
+    /// @details Each thread retains its most recent decompressions (of up to 16MB in total),
+    ///          so several handles built on the same unchanged compressed array only
+    ///          decompress it once. Decompressions are released once their compressed
+    ///          data no longer exists.
+    /// @note  Enabled by default.
+    static void setDecompressionCache(bool state);
+    /// Return @c true if read-only handles reuse recently decompressed arrays.
+    static bool decompressionCache();
+    /// @brief Release all cached decompressed arrays.
+    /// @note  Not thread-safe, must not be called while handles are being constructed.
+    static void clearDecompressionCache();
 
     /// Check the compressed bytes and flags. If they are equal, perform a deeper
     /// comparison check necessary on the inherited types (TypedAttributeArray)
@@ -322,8 +508,21 @@ private:
     virtual bool isEqual(const AttributeArray& other) const = 0;
 
 protected:
-    /// Obtain an Accessor that stores getter and setter functors.
-    virtual AccessorBasePtr getAccessor() const = 0;
+    /// @brief Obtain an Accessor that stores getter and setter functors.
+    /// @note The Accessor is shared by all arrays of the same type, so binding
+    /// a handle to an array does not allocate.
+    virtual const AccessorBase& getAccessor() const = 0;
+
+    /// Update the access stamp of this array to the current access epoch.
+    void touch() const;
+    /// Advance the access epoch and update the access stamp of this array, called on load.
+    void touchLoaded() const;
+
+    /// @brief Return an uncompressed copy of this compressed array, reusing a copy
+    ///        recently decompressed by the calling thread if the data is unchanged.
+    AttributeArray::Ptr cachedCopyUncompressed() const;
+    /// Assign a new, unique stamp to the compressed data of this array.
+    void stampCompressedData();
 
     /// Register a attribute type along with a factory function.
     static void registerType(const NamePair& type, FactoryMethod);
@@ -332,10 +531,17 @@ protected:
 
     size_t mCompressedBytes;
     uint16_t mFlags;
+    attribute_compression::Settings mCompressionSettings;
+
+    /// Identifies the compressed data of this array, cached decompressions hold a weak
+    /// reference to it so that they expire with the data (defined in the source file)
+    struct CompressedStamp;
+    boost::shared_ptr<CompressedStamp> mCompressedStamp;
 
     /// Out-of-core data
 #ifndef OPENVDB_2_ABI_COMPATIBLE
     boost::shared_ptr<FileInfo> mFileInfo;
+    mutable tbb::atomic<Index64> mAccessStamp;
 #endif
 }; // class AttributeArray
 
@@ -354,14 +560,20 @@ struct AttributeArray::Accessor : public AttributeArray::AccessorBase
     typedef T (*GetterPtr)(const AttributeArray* array, const Index n);
     typedef void (*SetterPtr)(AttributeArray* array, const Index n, const T& value);
     typedef void (*ValuePtr)(AttributeArray* array, const T& value);
+    typedef void (*RangeGetterPtr)(const AttributeArray* array, const Index n, const Index count, T* values);
+    typedef void (*RangeSetterPtr)(AttributeArray* array, const Index n, const Index count, const T* values);
 
-    Accessor(GetterPtr getter, SetterPtr setter, ValuePtr collapser, ValuePtr filler) :
-        mGetter(getter), mSetter(setter), mCollapser(collapser), mFiller(filler) { }
+    Accessor(GetterPtr getter, SetterPtr setter, ValuePtr collapser, ValuePtr filler,
+             RangeGetterPtr rangeGetter, RangeSetterPtr rangeSetter) :
+        mGetter(getter), mSetter(setter), mCollapser(collapser), mFiller(filler),
+        mRangeGetter(rangeGetter), mRangeSetter(rangeSetter) { }
 
     GetterPtr mGetter;
     SetterPtr mSetter;
     ValuePtr  mCollapser;
     ValuePtr  mFiller;
+    RangeGetterPtr mRangeGetter;
+    RangeSetterPtr mRangeSetter;
 }; // struct AttributeArray::Accessor
 
 
@@ -445,12 +657,99 @@ struct UnitVecCodec
 };
 
 
+/// @brief Integer values stored unchanged, but compressed in-memory as bit-packed deltas
+/// rather than with Blosc.
+/// @details Compressing an array packs its values into blocks of consecutive values, each
+/// block storing its first value relative to the minimum value of the array followed by
+/// the differences between successive values using only as many bits as the largest
+/// difference in the block requires. Nearly sorted values such as point ids shrink
+/// several-fold and can still be read from a compressed array without decompressing it.
+/// @note Only int32_t and int64_t values are supported.
+struct DeltaPackCodec
+{
+    template <typename T>
+    struct Storage { typedef T Type; };
+
+    template<typename ValueType> static void decode(const ValueType&, ValueType&);
+    template<typename ValueType> static void encode(const ValueType&, ValueType&);
+    static const char* name() { return "dpck"; }
+};
+
+
+/// @brief Voxel-space positions stored unchanged, but compressed in-memory by quantizing
+/// each array with only as many bits as its own values require.
+/// @details Compressing an array quantizes each axis relative to the bounds of the values
+/// in the array, using the fewest bits (at most 21) that keep every value within the
+/// tolerance of the array's compression settings. Leaves whose points span a small part
+/// of their voxels, or that have a coarse tolerance, use fewer bits. A tolerance of zero
+/// (the default) leaves the array uncompressed. Values can still be read from a compressed
+/// array without decompressing it.
+/// @note Only Vec3<float> values are supported and compression is lossy, the tolerance is
+/// in index space so a world-space tolerance must be divided by the voxel size.
+struct QuantizedPositionCodec
+{
+    template <typename T>
+    struct Storage { typedef T Type; };
+
+    template<typename ValueType> static void decode(const ValueType&, ValueType&);
+    template<typename ValueType> static void encode(const ValueType&, ValueType&);
+    static const char* name() { return "qpos"; }
+};
+
+
+namespace attribute_codec_internal {
+template <typename Codec, typename StorageType> struct PackedCodec;
+}
+
+
+namespace attribute_array_internal {
+
+/// @brief Cached bitwise OR and AND of all values of an array with integer storage (see
+/// TypedAttributeArray::bitSummary()), the summary is valid when mHasBitSummary is set,
+/// which is stored after (and loaded before) the summary so that it can be read unlocked
+template <typename StorageType, bool Integral = boost::is_integral<StorageType>::value>
+struct BitSummaryCache
+{
+    BitSummaryCache() : mAnyBits(0), mAllBits(0) { mHasBitSummary = false; }
+    BitSummaryCache(const BitSummaryCache& rhs) : mAnyBits(0), mAllBits(0) { this->copyBitSummary(rhs); }
+
+    BitSummaryCache& operator=(const BitSummaryCache& rhs) { this->copyBitSummary(rhs); return *this; }
+
+    void copyBitSummary(const BitSummaryCache& rhs)
+    {
+        mHasBitSummary = false;
+        if (!rhs.mHasBitSummary)    return;
+        mAnyBits = rhs.mAnyBits;
+        mAllBits = rhs.mAllBits;
+        mHasBitSummary = true;
+    }
+
+    void invalidateBitSummary() { mHasBitSummary = false; }
+
+    mutable StorageType mAnyBits;
+    mutable StorageType mAllBits;
+    mutable tbb::atomic<bool> mHasBitSummary;
+};
+
+/// Arrays with non-integer storage have no bit summary and store nothing
+template <typename StorageType>
+struct BitSummaryCache<StorageType, false>
+{
+    void copyBitSummary(const BitSummaryCache&) { }
+    void invalidateBitSummary() { }
+};
+
+} // namespace attribute_array_internal
+
+
 ////////////////////////////////////////
 
 
 /// Typed class for storing attribute data
 template<typename ValueType_, typename Codec_ = NullCodec>
-class TypedAttributeArray: public AttributeArray
+class TypedAttributeArray: public AttributeArray,
+    private attribute_array_internal::BitSummaryCache<
+        typename Codec_::template Storage<ValueType_>::Type>
 {
 public:
     typedef boost::shared_ptr<TypedAttributeArray>              Ptr;
@@ -540,16 +839,52 @@ public:
     /// Set value at given index @a n from @a sourceIndex of another @a sourceArray
     virtual void set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex);
 
+    /// @brief Decode the @a count values from index @a n onwards into @a values
+    /// (assumes uncompressed and in-core)
+    void getRangeUnsafe(Index n, Index count, ValueType* values) const;
+    /// Decode the @a count values from index @a n onwards into @a values
+    void getRange(Index n, Index count, ValueType* values) const;
+    /// @brief Encode @a count @a values into the array from index @a n onwards
+    /// (assumes uncompressed, in-core and not uniform)
+    void setRangeUnsafe(Index n, Index count, const ValueType* values);
+    /// Encode @a count @a values into the array from index @a n onwards
+    void setRange(Index n, Index count, const ValueType* values);
+
+    /// Non-member equivalent to getRangeUnsafe() that static_casts array to this TypedAttributeArray
+    /// (assumes uncompressed and in-core)
+    static void getRangeUnsafe(const AttributeArray* array, const Index n, const Index count,
+        ValueType* values);
+    /// Non-member equivalent to setRangeUnsafe() that static_casts array to this TypedAttributeArray
+    /// (assumes uncompressed, in-core and not uniform)
+    static void setRangeUnsafe(AttributeArray* array, const Index n, const Index count,
+        const ValueType* values);
+
     /// Return @c true if this array is stored as a single uniform value.
     virtual bool isUniform() const { return mIsUniform; }
-    /// @brief  Replace the single value storage with an array of length size().
-    /// @note   Non-uniform attributes are unchanged.
-    /// @param  fill toggle to initialize the array elements with the pre-expanded value.
+    /// @brief  Replace the single value or sparse storage with an array of length size().
+    /// @note   Attributes that are neither uniform nor sparse are unchanged.
+    /// @param  fill toggle to initialize the array elements with the pre-expanded values.
     virtual void expand(bool fill = true);
     /// Replace the existing array with a uniform zero value.
     virtual void collapse();
-    /// Compact the existing array to become uniform if all values are identical
+    /// @brief Compact the existing array to become uniform if all values are identical, or
+    ///        sparse if the values that differ from the most common value (when this is more
+    ///        than half of the values) can be stored in at most half of the memory.
+    /// @return @c true if the array is uniform.
+    /// @note  Compressed arrays are only made uniform, never sparse.
     virtual bool compact();
+    /// @brief Compact the existing array to become uniform if all values are identical,
+    ///        but never sparse.
+    /// @return @c true if the array is uniform.
+    bool compactUniform();
+    /// Return @c true if this array stores only the values that differ from a default value.
+    virtual bool isSparse() const { return mSparseIndices.get() != NULL; }
+
+    /// @brief Return the bitwise OR (@a anyBits) and bitwise AND (@a allBits) of all the values,
+    ///        which are the bits that are on in some and in every value respectively.
+    /// @details The summary is cached until the array is next modified, this is only
+    ///        available for integer storage types of up to 64 bits.
+    void bitSummary(StorageType& anyBits, StorageType& allBits) const;
 
     /// Replace the existing array with the given uniform value.
     void collapse(const ValueType& uniformValue);
@@ -562,7 +897,11 @@ public:
     /// Non-member equivalent to fill() that static_casts array to this TypedAttributeArray
     static void fill(AttributeArray* array, const ValueType& value);
 
-    /// Compress the attribute array.
+    /// Return @c true if values can be read while compressed (see DeltaPackCodec).
+    virtual bool isCompressedReadable() const { return PackedCodecT::IsPacked; }
+    /// @brief Compress the attribute array.
+    /// @details Sparse arrays are expanded to be compressed and are only replaced if the
+    ///          compressed data is smaller than the sparse storage.
     virtual bool compress();
     /// Uncompress the attribute array.
     virtual bool decompress();
@@ -575,18 +914,33 @@ public:
 
     /// Return @c true if this buffer's values have not yet been read from disk.
     inline bool isOutOfCore() const;
+    /// Return @c true if this buffer's values are accessed directly from a memory-mapped file.
+    inline bool isMapped() const;
 
     /// Ensures all data is in-core
     virtual void loadData() const;
+    /// Ensures all data is in-core and not accessed directly from a memory-mapped file
+    virtual void loadWritableData();
+    /// @brief Free the in-memory data of an unmodified, delay-loaded array and return it
+    ///        to the out-of-core state.
+    virtual bool releaseData();
 
 protected:
-    virtual AccessorBasePtr getAccessor() const;
+    virtual const AccessorBase& getAccessor() const;
 
 private:
+    typedef attribute_codec_internal::PackedCodec<Codec, StorageType> PackedCodecT;
+
     /// Load data from memory-mapped file.
     inline void doLoad() const;
     /// Load data from memory-mapped file (unsafe as this function is not protected by a mutex).
     inline void doLoadUnsafe() const;
+    /// Copy data accessed directly from a memory-mapped file into memory owned by this array
+    /// (unsafe as this function is not protected by a mutex).
+    inline void doCopyMappedUnsafe();
+    /// Detach the array from the file it was loaded from, as the data is to be modified
+    /// (unsafe as this function is not protected by a mutex).
+    inline void doDetachUnsafe();
 
     /// Toggle out-of-core state
     inline void setOutOfCore(const bool);
@@ -598,6 +952,11 @@ private:
     void allocate(const size_t size, const Index stride);
     void deallocate();
 
+    /// Replace the expanded array with sparse storage if this is beneficial.
+    void sparsify();
+    /// Return the stored value at index @a n of a sparse array.
+    inline const StorageType& sparseValue(Index n) const;
+
     /// Helper function for use with registerType()
     static AttributeArray::Ptr factory(size_t n, Index stride) { return TypedAttributeArray::create(n, stride); }
 
@@ -606,7 +965,16 @@ private:
     size_t          mSize;
     Index           mStride;
     bool            mIsUniform;
+    /// Sorted indices of the values that differ from the default value of a sparse array
+    /// (null unless sparse), the default value is stored at mData[0] followed by the value
+    /// of each index
+    boost::scoped_ptr<std::vector<Index> > mSparseIndices;
     tbb::spin_mutex mMutex;
+
+    /// Read-only data in a memory-mapped file (mData points to this data when mapped)
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    boost::shared_ptr<const char> mMappedData;
+#endif
 }; // class TypedAttributeArray
 
 
@@ -627,6 +995,10 @@ protected:
     typedef ValueType (*GetterPtr)(const AttributeArray* array, const Index n);
     typedef void (*SetterPtr)(AttributeArray* array, const Index n, const ValueType& value);
     typedef void (*ValuePtr)(AttributeArray* array, const ValueType& value);
+    typedef void (*RangeGetterPtr)(const AttributeArray* array, const Index n, const Index count,
+        ValueType* values);
+    typedef void (*RangeSetterPtr)(AttributeArray* array, const Index n, const Index count,
+        const ValueType* values);
 
 public:
     static Ptr create(const AttributeArray& array, const bool preserveCompression = true);
@@ -640,8 +1012,18 @@ public:
 
     bool isUniform() const;
 
+    /// @brief Return the value of element @a n (and of stride index @a m).
+    /// @note For arrays that are read while compressed (such as with the DeltaPackCodec),
+    /// values are decoded a block at a time into the handle, so a handle must not be
+    /// shared between threads.
     ValueType get(Index n, Index m = 0) const;
 
+    /// @brief Decode the values of the @a count elements from @a n onwards into @a values.
+    /// @details @a values must hold @c count*stride() values, ordered as get(n, m) with @a m
+    /// varying fastest. Unless the array is interleaved, this decodes one contiguous range
+    /// and reduces to a memory copy for arrays that use the null codec.
+    void getRange(Index n, Index count, ValueType* values) const;
+
 protected:
     Index index(Index n, Index m) const;
 
@@ -651,6 +1033,8 @@ protected:
     SetterPtr mSetter;
     ValuePtr  mCollapser;
     ValuePtr  mFiller;
+    RangeGetterPtr mRangeGetter;
+    RangeSetterPtr mRangeSetter;
 
 private:
     friend class ::TestAttributeArray;
@@ -667,11 +1051,42 @@ private:
     template <bool IsUnknownCodec>
     typename boost::enable_if_c<!IsUnknownCodec, ValueType>::type get(Index index) const;
 
+    template <bool IsUnknownCodec>
+    typename boost::enable_if_c<IsUnknownCodec, void>::type
+    getRange(Index index, Index count, ValueType* values) const;
+
+    template <bool IsUnknownCodec>
+    typename boost::enable_if_c<!IsUnknownCodec, void>::type
+    getRange(Index index, Index count, ValueType* values) const;
+
+    ValueType getPacked(Index index) const;
+
+    // number of values decoded at a time from an array that is read while compressed,
+    // this matches the block size of the DeltaPackCodec
+    static const Index PackedBlockSize = 64;
+
+    // the most recently decoded block of values, copies of a handle start without a block
+    // so that handles never share decoded values
+    struct PackedBlock
+    {
+        PackedBlock() : start(0), count(0) { }
+        PackedBlock(const PackedBlock&) : start(0), count(0) { }
+        PackedBlock& operator=(const PackedBlock&) { count = 0; return *this; }
+
+        boost::scoped_array<ValueType> values;
+        Index start;
+        Index count;
+    };
+
     // local copy of AttributeArray (to preserve compression)
     AttributeArray::Ptr mLocalArray;
 
     Index mStride;
     Index mSize;
+
+    // true if the array is read while compressed
+    bool mPacked;
+    mutable PackedBlock mPackedBlock;
 }; // class AttributeHandle
 
 
@@ -711,6 +1126,12 @@ public:
     void set(Index n, const ValueType& value);
     void set(Index n, Index m, const ValueType& value);
 
+    /// @brief Encode the values of the @a count elements from @a n onwards from @a values.
+    /// @details @a values must hold @c count*stride() values, ordered as set(n, m, value) with
+    /// @a m varying fastest. Unless the array is interleaved, this encodes one contiguous range
+    /// and reduces to a memory copy for arrays that use the null codec.
+    void setRange(Index n, Index count, const ValueType* values);
+
 private:
     friend class ::TestAttributeArray;
 
@@ -719,6 +1140,14 @@ private:
 
     template <bool IsUnknownCodec>
     typename boost::enable_if_c<!IsUnknownCodec, void>::type set(Index index, const ValueType& value) const;
+
+    template <bool IsUnknownCodec>
+    typename boost::enable_if_c<IsUnknownCodec, void>::type
+    setRange(Index index, Index count, const ValueType* values) const;
+
+    template <bool IsUnknownCodec>
+    typename boost::enable_if_c<!IsUnknownCodec, void>::type
+    setRange(Index index, Index count, const ValueType* values) const;
 }; // class AttributeWriteHandle
 
 
@@ -802,6 +1231,226 @@ UnitVecCodec::encode(const math::Vec3<T>& val, StorageType& data)
 }
 
 
+template<typename ValueType>
+inline void
+DeltaPackCodec::decode(const ValueType& data, ValueType& val)
+{
+    val = data;
+}
+
+
+template<typename ValueType>
+inline void
+DeltaPackCodec::encode(const ValueType& val, ValueType& data)
+{
+    data = val;
+}
+
+
+template<typename ValueType>
+inline void
+QuantizedPositionCodec::decode(const ValueType& data, ValueType& val)
+{
+    val = data;
+}
+
+
+template<typename ValueType>
+inline void
+QuantizedPositionCodec::encode(const ValueType& val, ValueType& data)
+{
+    data = val;
+}
+
+
+namespace attribute_codec_internal {
+
+/// @brief Batched conversions used to decode and encode ranges of values, these use SSE2,
+/// AVX2 or F16C instructions where supported by the CPU at runtime and scalar conversion
+/// otherwise, the results are identical to those of the scalar codecs
+/// {
+void decodeHalf(const half* data, float* values, const size_t count);
+void encodeHalf(const float* values, half* data, const size_t count);
+void decodeFixedPoint(const uint8_t* data, float* values, const size_t count);
+void decodeFixedPoint(const uint16_t* data, float* values, const size_t count);
+/// }
+
+/// Decode and encode contiguous ranges of values one value at a time
+template <typename Codec, typename StorageType, typename ValueType>
+struct ScalarRangeCodec
+{
+    static inline void decode(const StorageType* data, ValueType* values, const size_t count)
+    {
+        for (size_t i = 0; i < count; i++)  Codec::decode(data[i], values[i]);
+    }
+
+    static inline void encode(const ValueType* values, StorageType* data, const size_t count)
+    {
+        for (size_t i = 0; i < count; i++)  Codec::encode(values[i], data[i]);
+    }
+};
+
+/// Decode and encode contiguous ranges of values, specialized below for batched conversions
+template <typename Codec, typename StorageType, typename ValueType>
+struct RangeCodec : public ScalarRangeCodec<Codec, StorageType, ValueType> { };
+
+/// Values are stored unchanged by the null codec, so ranges are copied directly
+template <typename T>
+struct RangeCodec<NullCodec, T, T>
+{
+    static inline void decode(const T* data, T* values, const size_t count)
+    {
+        std::memcpy(values, data, count * sizeof(T));
+    }
+
+    static inline void encode(const T* values, T* data, const size_t count)
+    {
+        std::memcpy(data, values, count * sizeof(T));
+    }
+};
+
+template <>
+struct RangeCodec<TruncateCodec, half, float>
+{
+    static inline void decode(const half* data, float* values, const size_t count)
+    {
+        decodeHalf(data, values, count);
+    }
+
+    static inline void encode(const float* values, half* data, const size_t count)
+    {
+        encodeHalf(values, data, count);
+    }
+};
+
+/// Vec3 components are contiguous, so a range of vectors is converted as a range of scalars
+template <>
+struct RangeCodec<TruncateCodec, math::Vec3<half>, math::Vec3<float> >
+{
+    static inline void decode(const math::Vec3<half>* data, math::Vec3<float>* values, const size_t count)
+    {
+        decodeHalf(reinterpret_cast<const half*>(data), reinterpret_cast<float*>(values), count * 3);
+    }
+
+    static inline void encode(const math::Vec3<float>* values, math::Vec3<half>* data, const size_t count)
+    {
+        encodeHalf(reinterpret_cast<const float*>(values), reinterpret_cast<half*>(data), count * 3);
+    }
+};
+
+template <>
+struct RangeCodec<FixedPointCodec<true>, uint8_t, float>
+    : public ScalarRangeCodec<FixedPointCodec<true>, uint8_t, float>
+{
+    static inline void decode(const uint8_t* data, float* values, const size_t count)
+    {
+        decodeFixedPoint(data, values, count);
+    }
+};
+
+template <>
+struct RangeCodec<FixedPointCodec<false>, uint16_t, float>
+    : public ScalarRangeCodec<FixedPointCodec<false>, uint16_t, float>
+{
+    static inline void decode(const uint16_t* data, float* values, const size_t count)
+    {
+        decodeFixedPoint(data, values, count);
+    }
+};
+
+template <>
+struct RangeCodec<FixedPointCodec<true>, math::Vec3<uint8_t>, math::Vec3<float> >
+    : public ScalarRangeCodec<FixedPointCodec<true>, math::Vec3<uint8_t>, math::Vec3<float> >
+{
+    static inline void decode(const math::Vec3<uint8_t>* data, math::Vec3<float>* values, const size_t count)
+    {
+        decodeFixedPoint(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<float*>(values), count * 3);
+    }
+};
+
+template <>
+struct RangeCodec<FixedPointCodec<false>, math::Vec3<uint16_t>, math::Vec3<float> >
+    : public ScalarRangeCodec<FixedPointCodec<false>, math::Vec3<uint16_t>, math::Vec3<float> >
+{
+    static inline void decode(const math::Vec3<uint16_t>* data, math::Vec3<float>* values, const size_t count)
+    {
+        decodeFixedPoint(reinterpret_cast<const uint16_t*>(data), reinterpret_cast<float*>(values), count * 3);
+    }
+};
+
+/// @brief Pack integers into blocks of bit-packed deltas (see DeltaPackCodec) and return
+/// the packed buffer, or a null pointer if packing would not reduce the size of the data
+/// {
+char* packDeltas(const int32_t* values, const size_t count, size_t& packedBytes);
+char* packDeltas(const int64_t* values, const size_t count, size_t& packedBytes);
+/// }
+
+/// @brief Unpack @a count consecutive values starting at index @a n of a packed buffer
+/// {
+void unpackDeltas(const char* buffer, const Index n, const size_t count, int32_t* values);
+void unpackDeltas(const char* buffer, const Index n, const size_t count, int64_t* values);
+/// }
+
+/// @brief Quantize positions (see QuantizedPositionCodec) and return the packed buffer, or
+/// a null pointer if the tolerance is not positive, exceeds the precision of the quantized
+/// values or quantizing would not reduce the size of the data
+char* packQuantized(const math::Vec3<float>* values, const size_t count,
+                    const float tolerance, size_t& packedBytes);
+
+/// @brief Unpack @a count consecutive positions starting at index @a n of a packed buffer
+void unpackQuantized(const char* buffer, const Index n, const size_t count, math::Vec3<float>* values);
+
+/// In-memory compression by the codec itself, by default arrays are compressed with Blosc
+/// and must be decompressed before any values can be accessed
+template <typename Codec, typename StorageType>
+struct PackedCodec
+{
+    static const bool IsPacked = false;
+
+    static inline char* pack(const StorageType*, const size_t, size_t&,
+                             const attribute_compression::Settings&) { return 0; }
+
+    template <typename T>
+    static inline void unpack(const char*, const Index, const size_t, T*) { assert(false); }
+};
+
+template <typename StorageType>
+struct PackedCodec<DeltaPackCodec, StorageType>
+{
+    static const bool IsPacked = true;
+
+    static inline char* pack(const StorageType* data, const size_t count, size_t& packedBytes,
+                             const attribute_compression::Settings&)
+    {
+        return packDeltas(data, count, packedBytes);
+    }
+
+    static inline void unpack(const char* buffer, const Index n, const size_t count, StorageType* data)
+    {
+        unpackDeltas(buffer, n, count, data);
+    }
+};
+
+template <typename StorageType>
+struct PackedCodec<QuantizedPositionCodec, StorageType>
+{
+    static const bool IsPacked = true;
+
+    static inline char* pack(const StorageType* data, const size_t count, size_t& packedBytes,
+                             const attribute_compression::Settings& settings)
+    {
+        return packQuantized(data, count, settings.tolerance, packedBytes);
+    }
+
+    static inline void unpack(const char* buffer, const Index n, const size_t count, StorageType* data)
+    {
+        unpackQuantized(buffer, n, count, data);
+    }
+};
+
+} // namespace attribute_codec_internal
+
+
 ////////////////////////////////////////
 
 // TypedAttributeArray implementation
@@ -833,11 +1482,14 @@ TypedAttributeArray<ValueType_, Codec_>::TypedAttributeArray(const TypedAttribut
     , mSize(rhs.mSize)
     , mStride(rhs.mStride)
     , mIsUniform(rhs.mIsUniform)
+    , mSparseIndices(rhs.mSparseIndices ? new std::vector<Index>(*rhs.mSparseIndices) : NULL)
     , mMutex()
 {
     using attribute_compression::decompress;
     using attribute_compression::uncompressedSize;
 
+    this->copyBitSummary(rhs);
+
     // disable uncompress if data is not compressed
 
     if (!this->isCompressed())  uncompress = false;
@@ -845,16 +1497,35 @@ TypedAttributeArray<ValueType_, Codec_>::TypedAttributeArray(const TypedAttribut
     if (mIsUniform) {
         this->allocate(1, 1);
         mData[0] = rhs.mData[0];
+    } else if (this->isSparse()) {
+        mData = new StorageType[mSparseIndices->size() + 1];
+        std::copy(rhs.mData, rhs.mData + mSparseIndices->size() + 1, mData);
     } else if (this->isOutOfCore()) {
         // do nothing
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    } else if (rhs.isMapped()) {
+        // share the read-only mapped data, each array copies it before writing
+        mMappedData = rhs.mMappedData;
+        mData = rhs.mData;
+#endif
     } else if (this->isCompressed()) {
         char* buffer = 0;
         if (uncompress) {
             rhs.doLoad();
             const char* charBuffer = reinterpret_cast<char*>(rhs.mData);
-            buffer = decompress(charBuffer, uncompressedSize(charBuffer));
+            if (PackedCodecT::IsPacked) {
+                StorageType* data = new StorageType[mSize * mStride];
+                PackedCodecT::unpack(charBuffer, 0, mSize * mStride, data);
+                buffer = reinterpret_cast<char*>(data);
+            }
+            else {
+                buffer = decompress(charBuffer, uncompressedSize(charBuffer));
+            }
+        }
+        if (buffer) {
+            mCompressedBytes = 0;
+            mCompressedStamp.reset();
         }
-        if (buffer)         mCompressedBytes = 0;
         else {
             // decompression wasn't requested or failed so deep copy instead
             buffer = new char[mCompressedBytes];
@@ -879,17 +1550,30 @@ TypedAttributeArray<ValueType_, Codec_>::operator=(const TypedAttributeArray& rh
         this->deallocate();
 
         mFlags = rhs.mFlags;
+        mCompressionSettings = rhs.mCompressionSettings;
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+        mFileInfo = rhs.mFileInfo;
+#endif
         mCompressedBytes = rhs.mCompressedBytes;
+        mCompressedStamp = rhs.mCompressedStamp;
         mSize = rhs.mSize;
         mStride = rhs.mStride;
         mIsUniform = rhs.mIsUniform;
+        this->copyBitSummary(rhs);
 
         if (mIsUniform) {
             this->allocate(1, 1);
             mData[0] = rhs.mData[0];
+        } else if (rhs.isSparse()) {
+            mSparseIndices.reset(new std::vector<Index>(*rhs.mSparseIndices));
+            mData = new StorageType[mSparseIndices->size() + 1];
+            std::copy(rhs.mData, rhs.mData + mSparseIndices->size() + 1, mData);
 #ifndef OPENVDB_2_ABI_COMPATIBLE
         } else if (rhs.isOutOfCore()) {
-            mFileInfo = rhs.mFileInfo;
+            // do nothing
+        } else if (rhs.isMapped()) {
+            mMappedData = rhs.mMappedData;
+            mData = rhs.mData;
 #endif
         } else if (this->isCompressed()) {
             char* buffer = new char[mCompressedBytes];
@@ -900,6 +1584,8 @@ TypedAttributeArray<ValueType_, Codec_>::operator=(const TypedAttributeArray& rh
             memcpy(mData, rhs.mData, arrayMemUsage());
         }
     }
+
+    return *this;
 }
 
 
@@ -991,6 +1677,10 @@ TypedAttributeArray<ValueType_, Codec_>::arrayMemUsage(const bool maximum) const
     if (!maximum)
     {
         if (mIsUniform)                 return sizeof(StorageType);
+        if (this->isSparse()) {
+            return (mSparseIndices->size() + 1) * sizeof(StorageType) +
+                sizeof(std::vector<Index>) + mSparseIndices->capacity() * sizeof(Index);
+        }
         if (this->isOutOfCore())        return 0;
         if (this->isCompressed())       return mCompressedBytes;
     }
@@ -1014,55 +1704,158 @@ TypedAttributeArray<ValueType_, Codec_>::deallocate()
 {
 #ifndef OPENVDB_2_ABI_COMPATIBLE
     // detach from file if delay-loaded
-    if (this->isOutOfCore()) {
-        this->setOutOfCore(false);
-        this->mFileInfo.reset();
+    this->doDetachUnsafe();
+#endif
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    // release mapped data (not owned by this array)
+    if (mMappedData) {
+        mMappedData.reset();
+        mData = NULL;
     }
 #endif
     if (mData) {
         delete[] mData;
         mData = NULL;
     }
+    // release the sparse indices along with the values
+    mSparseIndices.reset();
 }
 
 
 template<typename ValueType_, typename Codec_>
-size_t
-TypedAttributeArray<ValueType_, Codec_>::memUsage() const
+inline const typename TypedAttributeArray<ValueType_, Codec_>::StorageType&
+TypedAttributeArray<ValueType_, Codec_>::sparseValue(Index n) const
 {
-    return sizeof(*this) + (mData != NULL ? this->arrayMemUsage() : 0);
+    const std::vector<Index>& indices = *mSparseIndices;
+
+    std::vector<Index>::const_iterator it = std::lower_bound(indices.begin(), indices.end(), n);
+
+    if (it == indices.end() || *it != n)    return mData[0];
+    return mData[1 + (it - indices.begin())];
 }
 
 
 template<typename ValueType_, typename Codec_>
-typename TypedAttributeArray<ValueType_, Codec_>::ValueType
-TypedAttributeArray<ValueType_, Codec_>::getUnsafe(Index n) const
+void
+TypedAttributeArray<ValueType_, Codec_>::bitSummary(StorageType& anyBits, StorageType& allBits) const
 {
-    assert(n < mSize * mStride);
-    assert(!this->isOutOfCore());
-    assert(!this->isCompressed());
+    BOOST_STATIC_ASSERT(boost::is_integral<StorageType>::value);
 
-    ValueType val;
-    Codec::decode(/*in=*/mData[mIsUniform ? 0 : n], /*out=*/val);
-    return val;
-}
+    if (!this->mHasBitSummary) {
+        if (this->isOutOfCore())        this->doLoad();
 
+        tbb::spin_mutex::scoped_lock lock(const_cast<TypedAttributeArray*>(this)->mMutex);
 
-template<typename ValueType_, typename Codec_>
-typename TypedAttributeArray<ValueType_, Codec_>::ValueType
-TypedAttributeArray<ValueType_, Codec_>::get(Index n) const
-{
-    if (n >= mSize * mStride)           OPENVDB_THROW(IndexError, "Out-of-range access.");
-    if (this->isOutOfCore())            this->doLoad();
-    if (this->isCompressed())           const_cast<TypedAttributeArray*>(this)->decompress();
+        if (!this->mHasBitSummary) {
 
-    return this->getUnsafe(n);
-}
+            // compressed data is decompressed into a temporary buffer, leaving the array
+            // unchanged as it may be shared with other read-only handles
 
+            boost::scoped_array<char> buffer;
+            const StorageType* data = mData;
 
-template<typename ValueType_, typename Codec_>
-template<typename T>
-void
+            if (this->isCompressed()) {
+                const size_t size = mSize * mStride;
+                const char* charBuffer = reinterpret_cast<const char*>(mData);
+
+                if (PackedCodecT::IsPacked) {
+                    buffer.reset(new char[size * sizeof(StorageType)]);
+                    PackedCodecT::unpack(charBuffer, 0, size,
+                        reinterpret_cast<StorageType*>(buffer.get()));
+                }
+                else {
+                    buffer.reset(attribute_compression::decompress(
+                        charBuffer, size * sizeof(StorageType)));
+                }
+
+                if (!buffer) {
+                    // summarize conservatively as some bits in some values, without caching
+                    anyBits = ~StorageType(0);
+                    allBits = StorageType(0);
+                    return;
+                }
+
+                data = reinterpret_cast<const StorageType*>(buffer.get());
+            }
+
+            // a sparse array holds its default value followed by each value that differs
+
+            const size_t count = mIsUniform ? 1 :
+                (this->isSparse() ? mSparseIndices->size() + 1 : mSize * mStride);
+
+            StorageType any(0), all(~StorageType(0));
+            for (size_t i = 0; i < count; ++i) {
+                any |= data[i];
+                all &= data[i];
+            }
+
+            this->mAnyBits = any;
+            this->mAllBits = all;
+            this->mHasBitSummary = true;
+        }
+    }
+
+    anyBits = this->mAnyBits;
+    allBits = this->mAllBits;
+}
+
+
+template<typename ValueType_, typename Codec_>
+size_t
+TypedAttributeArray<ValueType_, Codec_>::memUsage() const
+{
+    // mapped data is backed by the file rather than allocated by this array
+
+    if (this->isMapped())   return sizeof(*this);
+
+    return sizeof(*this) + (mData != NULL ? this->arrayMemUsage() : 0);
+}
+
+
+template<typename ValueType_, typename Codec_>
+typename TypedAttributeArray<ValueType_, Codec_>::ValueType
+TypedAttributeArray<ValueType_, Codec_>::getUnsafe(Index n) const
+{
+    assert(n < mSize * mStride);
+    assert(!this->isOutOfCore());
+    assert(!this->isCompressed() || PackedCodecT::IsPacked);
+
+    ValueType val;
+
+    // packed values are read directly from the compressed data
+
+    if (PackedCodecT::IsPacked && this->isCompressed()) {
+        PackedCodecT::unpack(reinterpret_cast<const char*>(mData), n, 1, &val);
+        return val;
+    }
+
+    if (this->isSparse()) {
+        Codec::decode(/*in=*/this->sparseValue(n), /*out=*/val);
+        return val;
+    }
+
+    Codec::decode(/*in=*/mData[mIsUniform ? 0 : n], /*out=*/val);
+    return val;
+}
+
+
+template<typename ValueType_, typename Codec_>
+typename TypedAttributeArray<ValueType_, Codec_>::ValueType
+TypedAttributeArray<ValueType_, Codec_>::get(Index n) const
+{
+    if (n >= mSize * mStride)           OPENVDB_THROW(IndexError, "Out-of-range access.");
+    if (this->isOutOfCore())            this->doLoad();
+    if (this->isCompressed() && !PackedCodecT::IsPacked) {
+        const_cast<TypedAttributeArray*>(this)->decompress();
+    }
+
+    return this->getUnsafe(n);
+}
+
+
+template<typename ValueType_, typename Codec_>
+template<typename T>
+void
 TypedAttributeArray<ValueType_, Codec_>::getUnsafe(Index n, T& val) const
 {
     val = static_cast<T>(this->getUnsafe(n));
@@ -1094,11 +1887,13 @@ TypedAttributeArray<ValueType_, Codec_>::setUnsafe(Index n, const ValueType& val
     assert(!this->isOutOfCore());
     assert(!this->isCompressed());
     assert(!this->isUniform());
+    assert(!this->isSparse());
 
     // this unsafe method assumes the data is not uniform, however if it is, this redirects the index
     // to zero, which is marginally less efficient but ensures not writing to an illegal address
 
     Codec::encode(/*in=*/val, /*out=*/mData[mIsUniform ? 0 : n]);
+    this->invalidateBitSummary();
 }
 
 
@@ -1107,9 +1902,9 @@ void
 TypedAttributeArray<ValueType_, Codec_>::set(Index n, const ValueType& val)
 {
     if (n >= mSize * mStride)           OPENVDB_THROW(IndexError, "Out-of-range access.");
-    if (this->isOutOfCore())            this->doLoad();
+    this->loadWritableData();
     if (this->isCompressed())           this->decompress();
-    if (this->isUniform())              this->expand();
+    if (this->isUniform() || this->isSparse())  this->expand();
 
     this->setUnsafe(n, val);
 }
@@ -1154,13 +1949,131 @@ TypedAttributeArray<ValueType_, Codec_>::set(Index n, const AttributeArray& sour
 }
 
 
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::getRangeUnsafe(Index n, Index count, ValueType* values) const
+{
+    typedef attribute_codec_internal::RangeCodec<Codec, StorageType, ValueType> RangeCodecT;
+
+    assert(n + count <= mSize * mStride);
+    assert(!this->isOutOfCore());
+    assert(!this->isCompressed() || PackedCodecT::IsPacked);
+
+    if (PackedCodecT::IsPacked && this->isCompressed()) {
+        PackedCodecT::unpack(reinterpret_cast<const char*>(mData), n, count, values);
+        return;
+    }
+
+    if (mIsUniform || this->isSparse()) {
+        ValueType val;
+        Codec::decode(/*in=*/mData[0], /*out=*/val);
+        std::fill(values, values + count, val);
+
+        // overwrite the default value with any sparse values within the range
+
+        if (!mSparseIndices)    return;
+
+        const std::vector<Index>& indices = *mSparseIndices;
+
+        std::vector<Index>::const_iterator it = std::lower_bound(indices.begin(), indices.end(), n);
+        for (; it != indices.end() && *it < n + count; ++it) {
+            Codec::decode(/*in=*/mData[1 + (it - indices.begin())], /*out=*/values[*it - n]);
+        }
+        return;
+    }
+
+    RangeCodecT::decode(/*in=*/mData + n, /*out=*/values, count);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::getRange(Index n, Index count, ValueType* values) const
+{
+    if (n + count > mSize * mStride)    OPENVDB_THROW(IndexError, "Out-of-range access.");
+    if (this->isOutOfCore())            this->doLoad();
+    if (this->isCompressed() && !PackedCodecT::IsPacked) {
+        const_cast<TypedAttributeArray*>(this)->decompress();
+    }
+
+    this->getRangeUnsafe(n, count, values);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::getRangeUnsafe(const AttributeArray* array, const Index n,
+    const Index count, ValueType* values)
+{
+    static_cast<const TypedAttributeArray<ValueType, Codec>*>(array)->getRangeUnsafe(n, count, values);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::setRangeUnsafe(Index n, Index count, const ValueType* values)
+{
+    typedef attribute_codec_internal::RangeCodec<Codec, StorageType, ValueType> RangeCodecT;
+
+    assert(n + count <= mSize * mStride);
+    assert(!this->isOutOfCore());
+    assert(!this->isCompressed());
+    assert(!this->isUniform());
+    assert(!this->isSparse());
+
+    this->invalidateBitSummary();
+
+    // as with setUnsafe(), a uniform array redirects all values to index zero
+
+    if (mIsUniform) {
+        if (count > 0)  Codec::encode(/*in=*/values[count - 1], /*out=*/mData[0]);
+        return;
+    }
+
+    RangeCodecT::encode(/*in=*/values, /*out=*/mData + n, count);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::setRange(Index n, Index count, const ValueType* values)
+{
+    if (n + count > mSize * mStride)    OPENVDB_THROW(IndexError, "Out-of-range access.");
+    this->loadWritableData();
+    if (this->isCompressed())           this->decompress();
+    if (this->isUniform() || this->isSparse())  this->expand();
+
+    this->setRangeUnsafe(n, count, values);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::setRangeUnsafe(AttributeArray* array, const Index n,
+    const Index count, const ValueType* values)
+{
+    static_cast<TypedAttributeArray<ValueType, Codec>*>(array)->setRangeUnsafe(n, count, values);
+}
+
+
 template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::expand(bool fill)
 {
-    if (!mIsUniform)    return;
+    if (!mIsUniform && !this->isSparse())   return;
+
+    // retain the sparse values, as deallocating releases them
+
+    boost::scoped_array<StorageType> sparseData;
+    boost::scoped_ptr<std::vector<Index> > sparseIndices;
+
+    if (this->isSparse()) {
+        sparseData.reset(mData);
+        mData = NULL;
+        sparseIndices.swap(mSparseIndices);
+    }
 
-    const StorageType val = mData[0];
+    const StorageType val = sparseData ? sparseData[0] : mData[0];
 
     {
         tbb::spin_mutex::scoped_lock lock(mMutex);
@@ -1169,10 +2082,16 @@ TypedAttributeArray<ValueType_, Codec_>::expand(bool fill)
     }
 
     mCompressedBytes = 0;
+    mCompressedStamp.reset();
     mIsUniform = false;
 
     if (fill) {
         for (size_t i = 0; i < mSize * mStride; ++i)  mData[i] = val;
+        if (sparseIndices) {
+            for (size_t i = 0; i < sparseIndices->size(); ++i) {
+                mData[(*sparseIndices)[i]] = sparseData[i + 1];
+            }
+        }
     }
 }
 
@@ -1180,20 +2099,92 @@ TypedAttributeArray<ValueType_, Codec_>::expand(bool fill)
 template<typename ValueType_, typename Codec_>
 bool
 TypedAttributeArray<ValueType_, Codec_>::compact()
+{
+    if (this->compactUniform())     return true;
+
+    if (!this->isSparse() && !this->isCompressed())     this->sparsify();
+    return false;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+TypedAttributeArray<ValueType_, Codec_>::compactUniform()
 {
     if (mIsUniform)     return true;
 
+    // sparse arrays only store values that differ from the default value
+
+    if (this->isSparse())   return false;
+
     // compaction is not possible if any values are different
     const ValueType_ val = this->get(0);
     for (size_t i = 1; i < mSize * mStride; i++) {
         if (this->get(i) != val)    return false;
     }
 
-    this->collapse(this->get(0));
+    this->collapse(val);
     return true;
 }
 
 
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::sparsify()
+{
+    assert(!mIsUniform && !this->isSparse() && !this->isCompressed() && !this->isOutOfCore());
+
+    const size_t size = mSize * mStride;
+
+    // values are compared by their stored bytes so that decoding is not required
+
+    struct Local {
+        static inline bool equal(const StorageType& a, const StorageType& b) {
+            return std::memcmp(&a, &b, sizeof(StorageType)) == 0;
+        }
+    };
+
+    // find the value that occurs in more than half of the array, if there is one, with a
+    // single pass majority vote
+
+    size_t candidate = 0, votes = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (votes == 0)                                 { candidate = i; votes = 1; }
+        else if (Local::equal(mData[i], mData[candidate]))  votes++;
+        else                                            votes--;
+    }
+
+    // sparse storage must use at most half of the memory of the expanded array
+
+    const size_t budget = size * sizeof(StorageType) / 2;
+    if (budget < sizeof(StorageType))   return;
+    const size_t maxSparse = (budget - sizeof(StorageType)) / (sizeof(StorageType) + sizeof(Index));
+
+    size_t sparseCount = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (!Local::equal(mData[i], mData[candidate]) && ++sparseCount > maxSparse)   return;
+    }
+
+    if (sparseCount == 0)   return;
+
+    std::vector<Index>* indices = new std::vector<Index>();
+    indices->reserve(sparseCount);
+    StorageType* data = new StorageType[sparseCount + 1];
+    data[0] = mData[candidate];
+
+    for (size_t i = 0; i < size; i++) {
+        if (Local::equal(mData[i], data[0]))    continue;
+        data[indices->size() + 1] = mData[i];
+        indices->push_back(Index(i));
+    }
+
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+    this->deallocate();
+    mData = data;
+    mSparseIndices.reset(indices);
+}
+
+
 template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::collapse()
@@ -1206,13 +2197,19 @@ template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::collapse(const ValueType& uniformValue)
 {
+    tbb::spin_mutex::scoped_lock lock(mMutex);
     if (!mIsUniform) {
-        tbb::spin_mutex::scoped_lock lock(mMutex);
         this->deallocate();
         this->allocate(1, 1);
         mIsUniform = true;
     }
+    else {
+        // the uniform value is about to be overwritten
+        this->doLoadUnsafe();
+        this->doDetachUnsafe();
+    }
     Codec::encode(uniformValue, mData[0]);
+    this->invalidateBitSummary();
 }
 
 
@@ -1228,16 +2225,24 @@ template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::fill(const ValueType& value)
 {
-    if (this->isOutOfCore()) {
+    // out-of-core and mapped data is about to be overwritten so does not need to be loaded
+
+    {
         tbb::spin_mutex::scoped_lock lock(mMutex);
-        this->deallocate();
-        this->allocate(mSize, mStride);
+        if (this->isOutOfCore() || this->isMapped() || this->isSparse()) {
+            this->deallocate();
+            this->allocate(mSize, mStride);
+        }
+        else {
+            this->doDetachUnsafe();
+        }
     }
 
-    const size_t size = mIsUniform ? 1 : mSize;
+    const size_t size = mIsUniform ? 1 : mSize * mStride;
     for (size_t i = 0; i < size; ++i)  {
         Codec::encode(value, mData[i]);
     }
+    this->invalidateBitSummary();
 }
 
 
@@ -1256,7 +2261,41 @@ TypedAttributeArray<ValueType_, Codec_>::compress()
     using attribute_compression::canCompress;
     using attribute_compression::compress;
 
-    if (!canCompress())     return false;
+    if (!PackedCodecT::IsPacked && !canCompress())     return false;
+
+    if (this->isSparse()) {
+
+        tbb::spin_mutex::scoped_lock lock(mMutex);
+
+        // sparse arrays are expanded into a temporary buffer to be compressed, and are only
+        // replaced if the compressed data is smaller than the sparse storage
+
+        const size_t size = mSize * mStride;
+        boost::scoped_array<StorageType> data(new StorageType[size]);
+
+        std::fill(data.get(), data.get() + size, mData[0]);
+        const std::vector<Index>& indices = *mSparseIndices;
+        for (size_t i = 0; i < indices.size(); ++i)    data[indices[i]] = mData[i + 1];
+
+        size_t outBytes = 0;
+        char* buffer = PackedCodecT::IsPacked ?
+            PackedCodecT::pack(data.get(), size, outBytes, mCompressionSettings) :
+            compress(reinterpret_cast<const char*>(data.get()), sizeof(StorageType),
+                     size * sizeof(StorageType), outBytes, mCompressionSettings);
+
+        if (!buffer)    return false;
+
+        if (outBytes >= this->arrayMemUsage()) {
+            delete[] buffer;
+            return false;
+        }
+
+        this->deallocate();
+        mData = reinterpret_cast<StorageType*>(buffer);
+        mCompressedBytes = outBytes;
+        this->stampCompressedData();
+        return true;
+    }
 
     if (!mIsUniform && !this->isCompressed()) {
 
@@ -1268,11 +2307,25 @@ TypedAttributeArray<ValueType_, Codec_>::compress()
         const size_t inBytes = this->arrayMemUsage();
         size_t outBytes;
         char* charBuffer = reinterpret_cast<char*>(mData);
-        char* buffer = compress(charBuffer, typeSize, inBytes, outBytes, /*cleanup=*/true);
+        const bool mapped = this->isMapped();
+        char* buffer = 0;
+
+        if (PackedCodecT::IsPacked) {
+            // packed by the codec instead of Blosc
+            buffer = PackedCodecT::pack(mData, mSize * mStride, outBytes, mCompressionSettings);
+            if (buffer && !mapped)  delete[] mData;
+        }
+        else {
+            buffer = compress(charBuffer, typeSize, inBytes, outBytes,
+                              /*cleanup=*/!mapped, mCompressionSettings);
+        }
 
         if (buffer) {
+            // mapped data is not owned by this array so must be released instead
+            if (mapped)     this->deallocate();
             mData = reinterpret_cast<StorageType*>(buffer);
             mCompressedBytes = outBytes;
+            this->stampCompressedData();
             return true;
         }
     }
@@ -1292,11 +2345,27 @@ TypedAttributeArray<ValueType_, Codec_>::decompress()
 
     if (this->isCompressed()) {
         this->doLoadUnsafe();
-        char* charBuffer = reinterpret_cast<char*>(this->mData);
+        const char* charBuffer = reinterpret_cast<const char*>(this->mData);
+
+        if (PackedCodecT::IsPacked) {
+            StorageType* data = new StorageType[mSize * mStride];
+            PackedCodecT::unpack(charBuffer, 0, mSize * mStride, data);
+            delete[] reinterpret_cast<char*>(mData);
+            mData = data;
+            mCompressedBytes = 0;
+            mCompressedStamp.reset();
+            return true;
+        }
+
+        // the new buffer is owned by the decompressor until it succeeds, so it is
+        // released if decompression fails or throws
+
         char* buffer = decompress(charBuffer, uncompressedSize(charBuffer));
         if (buffer) {
+            delete[] reinterpret_cast<char*>(mData);
             mData = reinterpret_cast<StorageType*>(buffer);
             mCompressedBytes = 0;
+            mCompressedStamp.reset();
             return true;
         }
     }
@@ -1317,6 +2386,18 @@ TypedAttributeArray<ValueType_, Codec_>::isOutOfCore() const
 }
 
 
+template<typename ValueType_, typename Codec_>
+bool
+TypedAttributeArray<ValueType_, Codec_>::isMapped() const
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    return bool(mMappedData);
+#else
+    return false;
+#endif
+}
+
+
 template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::setOutOfCore(const bool b)
@@ -1355,6 +2436,51 @@ TypedAttributeArray<ValueType_, Codec_>::loadData() const
 }
 
 
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::loadWritableData()
+{
+    this->doLoad();
+
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    if (!this->isMapped() && !mFileInfo)    return;
+
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+    this->doCopyMappedUnsafe();
+    this->doDetachUnsafe();
+#endif
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+TypedAttributeArray<ValueType_, Codec_>::releaseData()
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+
+    if (!this->isReleasable())  return false;
+
+    // free the in-memory data, retaining the file it can be re-loaded from
+
+    boost::shared_ptr<FileInfo> info = mFileInfo;
+    this->deallocate();
+    mFileInfo = info;
+
+    // compression state is restored to that of the data on disk
+
+    mCompressedBytes = info->memCompressed ? info->bytes : Index64(0);
+    if (mCompressedBytes)   this->stampCompressedData();
+    if (info->compressed)   mFlags |= WRITEDISKCOMPRESS;
+    this->setOutOfCore(true);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+
 template<typename ValueType_, typename Codec_>
 void
 TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
@@ -1370,6 +2496,7 @@ TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
     Int16 flags = Int16(0);
     is.read(reinterpret_cast<char*>(&flags), sizeof(Int16));
     mFlags = flags;
+    this->invalidateBitSummary();
 
     Index64 size = Index64(0);
     is.read(reinterpret_cast<char*>(&size), sizeof(Index64));
@@ -1381,6 +2508,7 @@ TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
 
     mIsUniform = mFlags & WRITEUNIFORM;
     mCompressedBytes = mFlags & WRITEMEMCOMPRESS ? bytes : Index64(0);
+    if (mCompressedBytes)   this->stampCompressedData();
 
     // read strided value (set to 1 if array is not strided)
 
@@ -1413,6 +2541,8 @@ TypedAttributeArray<ValueType_, Codec_>::read(std::istream& is)
         mFileInfo->bufpos = is.tellg();
         mFileInfo->mapping = mappedFile;
         mFileInfo->bytes = bytes;
+        mFileInfo->compressed = bool(mFlags & WRITEDISKCOMPRESS);
+        mFileInfo->memCompressed = mCompressedBytes != 0;
         mFileInfo->meta = io::getStreamMetadataPtr(is);
 
         // read and discard buffer
@@ -1453,6 +2583,15 @@ TypedAttributeArray<ValueType_, Codec_>::write(std::ostream& os, bool outputTran
 
     if (!outputTransient && this->isTransient())    return;
 
+    // sparse arrays are written expanded, stream compression is effective on the default values
+
+    if (this->isSparse()) {
+        TypedAttributeArray expanded(*this);
+        expanded.expand();
+        expanded.write(os, outputTransient);
+        return;
+    }
+
     Int16 flags(mFlags);
     Index64 size(mSize);
     Index stride(mStride);
@@ -1480,7 +2619,7 @@ TypedAttributeArray<ValueType_, Codec_>::write(std::ostream& os, bool outputTran
         const char* charBuffer = reinterpret_cast<const char*>(mData);
         const size_t typeSize = sizeof(StorageType);
         const size_t inBytes = this->arrayMemUsage();
-        compressedBuffer.reset(compress(charBuffer, typeSize, inBytes, compressedBytes));
+        compressedBuffer.reset(compress(charBuffer, typeSize, inBytes, compressedBytes, mCompressionSettings));
         if (compressedBuffer)   flags |= WRITEDISKCOMPRESS;
     }
 
@@ -1519,11 +2658,29 @@ TypedAttributeArray<ValueType_, Codec_>::doLoadUnsafe() const
 
     FileInfo& info = *(self->mFileInfo);
 
+    const Index64 bytes = info.bytes;
+
+    this->touchLoaded();
+
+    // access uncompressed data directly from the file if requested, this is only possible
+    // if the data is suitably aligned for the storage type
+
+    if (AttributeArray::mapUncompressedData() &&
+        !mIsUniform && !this->isCompressed() && !(mFlags & WRITEDISKCOMPRESS))
+    {
+        boost::shared_ptr<const char> data = attribute_mapping::mapData(info.mapping, info.bufpos, bytes);
+
+        if (data && reinterpret_cast<size_t>(data.get()) % boost::alignment_of<StorageType>::value == 0) {
+            self->mMappedData = data;
+            self->mData = const_cast<StorageType*>(reinterpret_cast<const StorageType*>(data.get()));
+            self->mFlags &= Int16(~OUTOFCORE);
+            return;
+        }
+    }
+
     boost::shared_ptr<std::streambuf> buf = info.mapping->createBuffer();
     std::istream is(buf.get());
 
-    const Index64 bytes = info.bytes;
-
     is.seekg(info.bufpos);
 
     char* buffer = new char[bytes];
@@ -1552,17 +2709,55 @@ TypedAttributeArray<ValueType_, Codec_>::doLoadUnsafe() const
 
 
 template<typename ValueType_, typename Codec_>
-AttributeArray::AccessorBasePtr
+void
+TypedAttributeArray<ValueType_, Codec_>::doCopyMappedUnsafe()
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    if (!mMappedData)   return;
+
+    // this function expects the mutex to already be locked
+
+    StorageType* data = new StorageType[mSize * mStride];
+    memcpy(data, mData, this->arrayMemUsage());
+
+    mMappedData.reset();
+    mData = data;
+#endif
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+TypedAttributeArray<ValueType_, Codec_>::doDetachUnsafe()
+{
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    // this function expects the mutex to already be locked
+
+    this->setOutOfCore(false);
+    mFileInfo.reset();
+#endif
+}
+
+
+template<typename ValueType_, typename Codec_>
+const AttributeArray::AccessorBase&
 TypedAttributeArray<ValueType_, Codec_>::getAccessor() const
 {
     // use the faster 'unsafe' get and set methods as attribute handles
     // ensure data is uncompressed and in-core when constructed
 
-    return AccessorBasePtr(new AttributeArray::Accessor<ValueType_>(
+    // the accessor only stores function pointers, so a single static
+    // instance is shared by all arrays of this type
+
+    static const AttributeArray::Accessor<ValueType_> accessor(
         &TypedAttributeArray<ValueType_, Codec_>::getUnsafe,
         &TypedAttributeArray<ValueType_, Codec_>::setUnsafe,
         &TypedAttributeArray<ValueType_, Codec_>::collapse,
-        &TypedAttributeArray<ValueType_, Codec_>::fill));
+        &TypedAttributeArray<ValueType_, Codec_>::fill,
+        &TypedAttributeArray<ValueType_, Codec_>::getRangeUnsafe,
+        &TypedAttributeArray<ValueType_, Codec_>::setRangeUnsafe);
+
+    return accessor;
 }
 
 
@@ -1574,6 +2769,8 @@ TypedAttributeArray<ValueType_, Codec_>::isEqual(const AttributeArray& other) co
     if(!otherT) return false;
     if(this->mSize != otherT->mSize ||
        this->mIsUniform != otherT->mIsUniform ||
+       this->isSparse() != otherT->isSparse() ||
+       (this->isSparse() && *this->mSparseIndices != *otherT->mSparseIndices) ||
        *this->sTypeName != *otherT->sTypeName) return false;
 
     this->doLoad();
@@ -1582,7 +2779,11 @@ TypedAttributeArray<ValueType_, Codec_>::isEqual(const AttributeArray& other) co
     const StorageType *target = this->mData, *source = otherT->mData;
     if (!target && !source) return true;
     if (!target || !source) return false;
-    Index n = this->mIsUniform ? 1 : mSize;
+    if (this->isCompressed()) {
+        // compressed sizes are known to match, so compare the compressed data directly
+        return std::memcmp(target, source, mCompressedBytes) == 0;
+    }
+    Index n = this->mIsUniform ? 1 : this->isSparse() ? Index(mSparseIndices->size() + 1) : mSize;
     while (n && math::isExactlyEqual(*target++, *source++)) --n;
     return n == 0;
 }
@@ -1647,6 +2848,7 @@ AttributeHandle<ValueType, CodecType, Strided, Interleaved>::AttributeHandle(con
     : mArray(&array)
     , mStride(array.stride())
     , mSize(array.size())
+    , mPacked(false)
 {
     // check compatibility of array with handle
 
@@ -1669,36 +2871,41 @@ AttributeHandle<ValueType, CodecType, Strided, Interleaved>::AttributeHandle(con
         OPENVDB_THROW(TypeError, "Cannot bind handle due to incompatible type of AttributeArray.");
     }
 
-    // load data if delay-loaded
+    // load data if delay-loaded and mark the array as recently used
 
     mArray->loadData();
+    array.touch();
 
-    // if array is compressed and preserve compression is true, copy and decompress
-    // into a local copy that is destroyed with handle to maintain thread-safety
+    // if array is compressed and preserve compression is true, decompress into a local
+    // copy that is destroyed with the handle to maintain thread-safety (the copy may be
+    // shared with the calling thread's cache of recent decompressions, but is never modified),
+    // arrays that can be read while compressed are accessed directly instead
 
     if (array.isCompressed())
     {
-        if (preserveCompression) {
-            mLocalArray = array.copyUncompressed();
-            mLocalArray->decompress();
+        if (!preserveCompression) {
+            const_cast<AttributeArray*>(mArray)->decompress();
+        }
+        else if (!array.isCompressedReadable()) {
+            mLocalArray = array.cachedCopyUncompressed();
             mArray = mLocalArray.get();
         }
         else {
-            const_cast<AttributeArray*>(mArray)->decompress();
+            mPacked = true;
         }
     }
 
     // bind getter and setter methods
 
-    AttributeArray::AccessorBasePtr accessor = mArray->getAccessor();
-    assert(accessor);
-
-    AttributeArray::Accessor<ValueType>* typedAccessor = static_cast<AttributeArray::Accessor<ValueType>*>(accessor.get());
+    const AttributeArray::Accessor<ValueType>& typedAccessor =
+        static_cast<const AttributeArray::Accessor<ValueType>&>(mArray->getAccessor());
 
-    mGetter = typedAccessor->mGetter;
-    mSetter = typedAccessor->mSetter;
-    mCollapser = typedAccessor->mCollapser;
-    mFiller = typedAccessor->mFiller;
+    mGetter = typedAccessor.mGetter;
+    mSetter = typedAccessor.mSetter;
+    mCollapser = typedAccessor.mCollapser;
+    mFiller = typedAccessor.mFiller;
+    mRangeGetter = typedAccessor.mRangeGetter;
+    mRangeSetter = typedAccessor.mRangeSetter;
 }
 
 template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
@@ -1734,9 +2941,33 @@ Index AttributeHandle<ValueType, CodecType, Strided, Interleaved>::index(Index n
 template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
 ValueType AttributeHandle<ValueType, CodecType, Strided, Interleaved>::get(Index n, Index m) const
 {
+    if (mPacked)    return this->getPacked(this->index(n, m));
+
     return this->get<boost::is_same<CodecType, UnknownCodec>::value>(this->index(n, m));
 }
 
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+ValueType AttributeHandle<ValueType, CodecType, Strided, Interleaved>::getPacked(Index index) const
+{
+    // decode the aligned block containing the value unless it was the last block decoded,
+    // so that sequential access decodes each value once rather than each value of its block
+
+    if (index - mPackedBlock.start >= mPackedBlock.count) {
+        if (!mPackedBlock.values)   mPackedBlock.values.reset(new ValueType[PackedBlockSize]);
+
+        const Index start = index - index % PackedBlockSize;
+        const Index count = std::min(Index(PackedBlockSize), mSize * mStride - start);
+
+        this->getRange<boost::is_same<CodecType, UnknownCodec>::value>(
+            start, count, mPackedBlock.values.get());
+
+        mPackedBlock.start = start;
+        mPackedBlock.count = count;
+    }
+
+    return mPackedBlock.values[index - mPackedBlock.start];
+}
+
 template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
 template <bool IsUnknownCodec>
 typename boost::enable_if_c<IsUnknownCodec, ValueType>::type
@@ -1757,6 +2988,42 @@ AttributeHandle<ValueType, CodecType, Strided, Interleaved>::get(Index index) co
     return TypedAttributeArray<ValueType, CodecType>::getUnsafe(mArray, index);
 }
 
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+void AttributeHandle<ValueType, CodecType, Strided, Interleaved>::getRange(Index n, Index count, ValueType* values) const
+{
+    assert(n + count <= mSize);
+
+    if (Strided && Interleaved) {
+        // interleaved values of an element are not contiguous
+        for (Index i = 0; i < count; i++) {
+            for (Index m = 0; m < mStride; m++)     *values++ = this->get(n + i, m);
+        }
+        return;
+    }
+
+    this->getRange<boost::is_same<CodecType, UnknownCodec>::value>(this->index(n, 0), count * mStride, values);
+}
+
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+template <bool IsUnknownCodec>
+typename boost::enable_if_c<IsUnknownCodec, void>::type
+AttributeHandle<ValueType, CodecType, Strided, Interleaved>::getRange(Index index, Index count, ValueType* values) const
+{
+    // if the codec is unknown, use the range getter functor
+
+    (*mRangeGetter)(mArray, index, count, values);
+}
+
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+template <bool IsUnknownCodec>
+typename boost::enable_if_c<!IsUnknownCodec, void>::type
+AttributeHandle<ValueType, CodecType, Strided, Interleaved>::getRange(Index index, Index count, ValueType* values) const
+{
+    // if the codec is known, call the method on the attribute array directly
+
+    TypedAttributeArray<ValueType, CodecType>::getRangeUnsafe(mArray, index, count, values);
+}
+
 template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
 bool AttributeHandle<ValueType, CodecType, Strided, Interleaved>::isUniform() const
 {
@@ -1780,7 +3047,13 @@ template <typename ValueType, typename CodecType, bool Strided, bool Interleaved
 AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::AttributeWriteHandle(AttributeArray& array, const bool expand)
     : AttributeHandle<ValueType, CodecType, Strided, Interleaved>(array, /*preserveCompression = */ false)
 {
-    if (expand)     array.expand();
+    // copy any data accessed directly from a memory-mapped file before writing
+
+    array.loadWritableData();
+
+    // sparse arrays cannot be written in-place so are always expanded
+
+    if (expand || array.isSparse())     array.expand();
 }
 
 template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
@@ -1795,6 +3068,23 @@ void AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::set(Index
     this->set<boost::is_same<CodecType, UnknownCodec>::value>(this->index(n, m), value);
 }
 
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+void AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::setRange(Index n, Index count, const ValueType* values)
+{
+    assert(n + count <= this->size());
+
+    if (Strided && Interleaved) {
+        // interleaved values of an element are not contiguous
+        for (Index i = 0; i < count; i++) {
+            for (Index m = 0; m < this->stride(); m++)  this->set(n + i, m, *values++);
+        }
+        return;
+    }
+
+    this->setRange<boost::is_same<CodecType, UnknownCodec>::value>(
+        this->index(n, 0), count * this->stride(), values);
+}
+
 template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
 void AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::expand(const bool fill)
 {
@@ -1845,6 +3135,185 @@ AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::set(Index inde
     TypedAttributeArray<ValueType, CodecType>::setUnsafe(const_cast<AttributeArray*>(this->mArray), index, value);
 }
 
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+template <bool IsUnknownCodec>
+typename boost::enable_if_c<IsUnknownCodec, void>::type
+AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::setRange(Index index, Index count, const ValueType* values) const
+{
+    // if the codec is unknown, use the range setter functor
+
+    (*this->mRangeSetter)(const_cast<AttributeArray*>(this->mArray), index, count, values);
+}
+
+template <typename ValueType, typename CodecType, bool Strided, bool Interleaved>
+template <bool IsUnknownCodec>
+typename boost::enable_if_c<!IsUnknownCodec, void>::type
+AttributeWriteHandle<ValueType, CodecType, Strided, Interleaved>::setRange(Index index, Index count, const ValueType* values) const
+{
+    // if the codec is known, call the method on the attribute array directly
+
+    TypedAttributeArray<ValueType, CodecType>::setRangeUnsafe(
+        const_cast<AttributeArray*>(this->mArray), index, count, values);
+}
+
+
+
+////////////////////////////////////////
+
+
+namespace attribute_traits
+{
+    /// @brief The codecs that TypedAttributeArrays of each value type are registered with
+    /// in openvdb::points::initialize() (see registerTypedAttributeArrays()), in the order
+    /// they are tried during codec dispatch.
+    template <typename T> struct RegisteredCodecs { typedef boost::mpl::vector<NullCodec> Type; };
+
+    template <> struct RegisteredCodecs<int32_t> {
+        typedef boost::mpl::vector<NullCodec, DeltaPackCodec> Type;
+    };
+
+    template <> struct RegisteredCodecs<int64_t> {
+        typedef boost::mpl::vector<NullCodec, DeltaPackCodec> Type;
+    };
+
+    template <> struct RegisteredCodecs<float> {
+        typedef boost::mpl::vector<NullCodec, TruncateCodec> Type;
+    };
+
+    template <> struct RegisteredCodecs<math::Vec3<float> > {
+        typedef boost::mpl::vector< NullCodec, TruncateCodec, FixedPointCodec<true>,
+                                    FixedPointCodec<false>, UnitVecCodec,
+                                    QuantizedPositionCodec> Type;
+    };
+}
+
+
+namespace attribute_dispatch_internal {
+
+
+template <typename ValueType, typename IterT, typename EndT>
+struct CodecDispatch
+{
+    template <typename ArrayT, typename OpT>
+    static bool apply(ArrayT& array, OpT& op)
+    {
+        typedef typename boost::mpl::deref<IterT>::type             CodecType;
+        typedef TypedAttributeArray<ValueType, CodecType>           TypedAttributeArrayT;
+
+        if (array.template isType<TypedAttributeArrayT>()) {
+            op(TypedAttributeArrayT::cast(array));
+            return true;
+        }
+
+        return CodecDispatch<ValueType, typename boost::mpl::next<IterT>::type, EndT>::apply(array, op);
+    }
+};
+
+
+template <typename ValueType, typename EndT>
+struct CodecDispatch<ValueType, EndT, EndT>
+{
+    template <typename ArrayT, typename OpT>
+    static bool apply(ArrayT&, OpT&) { return false; }
+};
+
+
+template <typename ValueType, typename IterT, typename EndT>
+struct CodecRegistration
+{
+    static void apply()
+    {
+        typedef typename boost::mpl::deref<IterT>::type             CodecType;
+
+        TypedAttributeArray<ValueType, CodecType>::registerType();
+
+        CodecRegistration<ValueType, typename boost::mpl::next<IterT>::type, EndT>::apply();
+    }
+};
+
+
+template <typename ValueType, typename EndT>
+struct CodecRegistration<ValueType, EndT, EndT>
+{
+    static void apply() { }
+};
+
+
+template <typename ValueType, typename CodecsT, typename ArrayT, typename OpT>
+inline bool
+dispatch(ArrayT& array, OpT& op)
+{
+    typedef typename boost::mpl::begin<CodecsT>::type       BeginT;
+    typedef typename boost::mpl::end<CodecsT>::type         EndT;
+
+    return CodecDispatch<ValueType, BeginT, EndT>::apply(array, op);
+}
+
+
+} // namespace attribute_dispatch_internal
+
+
+/// @brief Resolve the codec of an attribute array with a known value type and invoke
+/// @a op with the array cast to its concrete TypedAttributeArray<ValueType, Codec> type.
+///
+/// @details @a op must provide a templated call operator accepting any
+/// TypedAttributeArray<ValueType, Codec>& (or const& for a const array), so that
+/// the body of the operator is compiled once per codec and per-value access inside
+/// it is fully inlined, rather than going through the function pointers of an
+/// AttributeHandle with an UnknownCodec. The codec is resolved once per call, which
+/// makes this well suited to resolving an array once per leaf and then iterating
+/// over its points.
+///
+/// @return @c false if the array does not match any of the candidate codecs,
+///         in which case @a op is not invoked.
+///
+/// @note The candidate codecs default to those registered for @a ValueType
+///       (see attribute_traits::RegisteredCodecs), an alternative
+///       boost::mpl sequence of codecs may be supplied for custom types.
+template <typename ValueType, typename OpT>
+inline bool
+dispatchTypedAttributeArray(AttributeArray& array, OpT& op)
+{
+    typedef typename attribute_traits::RegisteredCodecs<ValueType>::Type CodecsT;
+    return attribute_dispatch_internal::dispatch<ValueType, CodecsT>(array, op);
+}
+
+template <typename ValueType, typename OpT>
+inline bool
+dispatchTypedAttributeArray(const AttributeArray& array, OpT& op)
+{
+    typedef typename attribute_traits::RegisteredCodecs<ValueType>::Type CodecsT;
+    return attribute_dispatch_internal::dispatch<ValueType, CodecsT>(array, op);
+}
+
+template <typename ValueType, typename CodecsT, typename OpT>
+inline bool
+dispatchTypedAttributeArray(AttributeArray& array, OpT& op)
+{
+    return attribute_dispatch_internal::dispatch<ValueType, CodecsT>(array, op);
+}
+
+template <typename ValueType, typename CodecsT, typename OpT>
+inline bool
+dispatchTypedAttributeArray(const AttributeArray& array, OpT& op)
+{
+    return attribute_dispatch_internal::dispatch<ValueType, CodecsT>(array, op);
+}
+
+
+/// @brief Register a TypedAttributeArray of @a ValueType with each of the codecs listed for
+/// it in attribute_traits::RegisteredCodecs, as openvdb::points::initialize() does for the
+/// built-in value types.
+template <typename ValueType>
+inline void
+registerTypedAttributeArrays()
+{
+    typedef typename attribute_traits::RegisteredCodecs<ValueType>::Type CodecsT;
+    typedef typename boost::mpl::begin<CodecsT>::type       BeginT;
+    typedef typename boost::mpl::end<CodecsT>::type         EndT;
+
+    attribute_dispatch_internal::CodecRegistration<ValueType, BeginT, EndT>::apply();
+}
 
 } // namespace tools
 
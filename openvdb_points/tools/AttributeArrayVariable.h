@@ -0,0 +1,978 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+//
+/// @file AttributeArrayVariable.h
+///
+/// @brief  Attribute array storage for a variable number of values per point
+///         (array-of-arrays attributes).
+///
+/// @details Values are packed contiguously in point order with a per-point offset
+///          into the packed values, so memory is proportional to the number of values
+///          stored rather than to the maximum number of values of any one point.
+///
+
+
+#ifndef OPENVDB_TOOLS_ATTRIBUTE_ARRAY_VARIABLE_HAS_BEEN_INCLUDED
+#define OPENVDB_TOOLS_ATTRIBUTE_ARRAY_VARIABLE_HAS_BEEN_INCLUDED
+
+#include <openvdb_points/tools/AttributeArray.h>
+
+#include <vector>
+
+
+namespace openvdb {
+OPENVDB_USE_VERSION_NAMESPACE
+namespace OPENVDB_VERSION_NAME {
+namespace tools {
+
+
+////////////////////////////////////////
+
+
+/// Typed class for storing a variable number of values per point
+template<typename ValueType_, typename Codec_ = NullCodec>
+class VariableAttributeArray: public AttributeArray
+{
+public:
+    typedef boost::shared_ptr<VariableAttributeArray>           Ptr;
+    typedef boost::shared_ptr<const VariableAttributeArray>     ConstPtr;
+
+    typedef ValueType_                                          ValueType;
+    typedef Codec_                                              Codec;
+    typedef typename Codec::template Storage<ValueType>::Type   StorageType;
+
+    //////////
+
+    /// Default constructor, constructs an array of @a n points that store no values.
+    explicit VariableAttributeArray(size_t n = 1);
+    /// Deep copy constructor (optionally decompress during copy).
+    VariableAttributeArray(const VariableAttributeArray&, bool uncompress = false);
+    /// Deep copy assignment operator.
+    VariableAttributeArray& operator=(const VariableAttributeArray&);
+
+    virtual ~VariableAttributeArray() { }
+
+    /// Return a copy of this attribute.
+    virtual AttributeArray::Ptr copy() const;
+
+    /// Return an uncompressed copy of this attribute (will just return a copy if not compressed).
+    virtual AttributeArray::Ptr copyUncompressed() const;
+
+    /// @brief Return a new attribute array of the given length @a n that stores no values.
+    /// @note  The @a stride is ignored, as each point stores a variable number of values.
+    static Ptr create(size_t n, Index stride = 1);
+
+    /// Cast an AttributeArray to VariableAttributeArray<T>
+    static VariableAttributeArray& cast(AttributeArray& attributeArray);
+
+    /// Cast an AttributeArray to VariableAttributeArray<T>
+    static const VariableAttributeArray& cast(const AttributeArray& attributeArray);
+
+    /// @brief Return the name of this attribute's type (includes codec)
+    /// @note  The value type name is suffixed with "[]" to distinguish it from the
+    ///        TypedAttributeArray of the same value type.
+    static const NamePair& attributeType();
+    /// Return the name of this attribute's type.
+    virtual const NamePair& type() const { return attributeType(); }
+
+    /// Return @c true if this attribute type is registered.
+    static bool isRegistered();
+    /// Register this attribute type along with a factory function.
+    static void registerType();
+    /// Remove this attribute type from the registry.
+    static void unregisterType();
+
+    /// Return the number of points in this array.
+    virtual size_t size() const { return mSize; }
+
+    /// Return the stride of this array, which is always one.
+    virtual Index stride() const { return 1; }
+
+    /// Return true if stride is greater than one.
+    virtual bool isStrided() const { return false; }
+
+    /// Return the number of bytes of memory used by this attribute.
+    virtual size_t memUsage() const;
+
+    /// Return the total number of values stored by all points.
+    Index valueCount() const { return mValueCount; }
+    /// Return the number of values stored by point @a n.
+    Index count(Index n) const;
+
+    /// Return the value at index @a m of point @a n.
+    ValueType get(Index n, Index m) const;
+    /// Return all the values of point @a n.
+    void get(Index n, std::vector<ValueType>& values) const;
+
+    /// Set the value at index @a m of point @a n (which must already store more than @a m values).
+    void set(Index n, Index m, const ValueType& value);
+    /// @brief Replace the values of point @a n with the @a count @a values.
+    /// @note  This is inexpensive if the number of values of the point is unchanged or if no
+    ///        subsequent point stores any values, so arrays are best populated in point order.
+    void set(Index n, const ValueType* values, Index count);
+    /// Replace the values of point @a n.
+    void set(Index n, const std::vector<ValueType>& values);
+
+    /// @brief Set the number of values stored by every point, retaining existing values
+    ///        up to the new count and initializing any additional values to zero.
+    void setCounts(const std::vector<Index>& counts);
+
+    /// Set the values of point @a n from point @a sourceIndex of another @a sourceArray
+    virtual void set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex);
+
+    /// Return @c true if no point stores any values.
+    virtual bool isUniform() const { return mValueCount == 0; }
+    /// Does nothing, as there are no values to expand.
+    virtual void expand(bool fill = true);
+    /// Remove all values from all points.
+    virtual void collapse();
+    /// @brief Release any unused storage, so that memory is proportional to the number of values,
+    ///        returning @c true if no point stores any values.
+    virtual bool compact();
+
+    /// Compress the attribute array.
+    virtual bool compress();
+    /// Uncompress the attribute array.
+    virtual bool decompress();
+
+    /// Read attribute data from a stream.
+    virtual void read(std::istream& is);
+    /// Write attribute data to a stream.
+    /// @param outputTransient if true, write out transient attributes
+    virtual void write(std::ostream&, bool outputTransient = false) const;
+
+    /// Does nothing, as arrays of this type are always read in-core.
+    virtual void loadData() const { }
+    /// Does nothing, as arrays of this type are always read in-core.
+    virtual void loadWritableData() { }
+    /// Return @c false, as arrays of this type are always read in-core.
+    virtual bool releaseData() { return false; }
+
+protected:
+    virtual const AccessorBase& getAccessor() const;
+
+private:
+    /// Compare the this data to another attribute array. Used by the base class comparison operator
+    virtual bool isEqual(const AttributeArray& other) const;
+
+    /// Return the offset of the first value of point @a n into the packed values.
+    inline Index start(Index n) const;
+    /// Resize the storage of point @a n to @a count values and return the offset of its first value.
+    Index resizeUnsafe(Index n, Index count);
+    /// Decompress this array, even though the array is const.
+    inline void doDecompress() const;
+
+    /// Helper function for use with registerType()
+    static AttributeArray::Ptr factory(size_t n, Index strideOrTotalSize) {
+        return VariableAttributeArray::create(n, strideOrTotalSize);
+    }
+
+    static tbb::atomic<const NamePair*> sTypeName;
+
+    size_t                      mSize;
+    Index                       mValueCount;
+    /// Offsets of the values of each point into the packed values, followed by the value count.
+    /// @note Only the leading points that have ever stored values are included, the offsets
+    ///       are empty if no point stores values.
+    std::vector<Index>          mOffsets;
+    std::vector<StorageType>    mValues;
+    /// When compressed, the compressed offsets followed by the compressed values
+    boost::scoped_array<char>   mCompressedData;
+    size_t                      mCompressedOffsetBytes;
+    tbb::spin_mutex             mMutex;
+}; // class VariableAttributeArray
+
+
+////////////////////////////////////////
+
+
+/// Read-only access to the values of a VariableAttributeArray
+template <typename ValueType, typename CodecType = NullCodec>
+class VariableAttributeHandle
+{
+public:
+    typedef VariableAttributeHandle<ValueType, CodecType>   Handle;
+    typedef boost::shared_ptr<Handle>                       Ptr;
+    typedef VariableAttributeArray<ValueType, CodecType>    ArrayType;
+
+    static Ptr create(const AttributeArray& array, const bool preserveCompression = true);
+
+    VariableAttributeHandle(const AttributeArray& array, const bool preserveCompression = true);
+
+    virtual ~VariableAttributeHandle() { }
+
+    size_t size() const { return mArray->size(); }
+    bool isUniform() const { return mArray->isUniform(); }
+
+    /// Return the number of values stored by point @a n.
+    Index count(Index n) const { return mArray->count(n); }
+
+    /// Return the value at index @a m of point @a n.
+    ValueType get(Index n, Index m) const { return mArray->get(n, m); }
+    /// Return all the values of point @a n.
+    void get(Index n, std::vector<ValueType>& values) const { mArray->get(n, values); }
+
+protected:
+    const ArrayType* mArray;
+
+private:
+    // local copy of VariableAttributeArray (to preserve compression)
+    AttributeArray::Ptr mLocalArray;
+}; // class VariableAttributeHandle
+
+
+////////////////////////////////////////
+
+
+/// Write-able version of VariableAttributeHandle
+template <typename ValueType, typename CodecType = NullCodec>
+class VariableAttributeWriteHandle : public VariableAttributeHandle<ValueType, CodecType>
+{
+public:
+    typedef VariableAttributeWriteHandle<ValueType, CodecType>  Handle;
+    typedef boost::shared_ptr<Handle>                           Ptr;
+    typedef VariableAttributeArray<ValueType, CodecType>        ArrayType;
+
+    static Ptr create(AttributeArray& array);
+
+    VariableAttributeWriteHandle(AttributeArray& array);
+
+    virtual ~VariableAttributeWriteHandle() { }
+
+    /// Set the value at index @a m of point @a n.
+    void set(Index n, Index m, const ValueType& value) { this->array().set(n, m, value); }
+    /// Replace the values of point @a n.
+    void set(Index n, const std::vector<ValueType>& values) { this->array().set(n, values); }
+    /// Set the number of values stored by every point.
+    void setCounts(const std::vector<Index>& counts) { this->array().setCounts(counts); }
+
+    /// Remove all values from all points.
+    void collapse() { this->array().collapse(); }
+    /// Release any unused storage, returning @c true if no point stores any values.
+    bool compact() { return this->array().compact(); }
+
+private:
+    ArrayType& array() { return const_cast<ArrayType&>(*this->mArray); }
+}; // class VariableAttributeWriteHandle
+
+
+////////////////////////////////////////
+
+// VariableAttributeArray implementation
+
+template<typename ValueType_, typename Codec_>
+tbb::atomic<const NamePair*> VariableAttributeArray<ValueType_, Codec_>::sTypeName;
+
+
+template<typename ValueType_, typename Codec_>
+VariableAttributeArray<ValueType_, Codec_>::VariableAttributeArray(size_t n)
+    : AttributeArray()
+    , mSize(std::max(size_t(1), n))
+    , mValueCount(0)
+    , mCompressedOffsetBytes(0)
+{
+}
+
+
+template<typename ValueType_, typename Codec_>
+VariableAttributeArray<ValueType_, Codec_>::VariableAttributeArray(
+    const VariableAttributeArray& rhs, bool uncompress)
+    : AttributeArray(rhs)
+    , mSize(rhs.mSize)
+    , mValueCount(rhs.mValueCount)
+    , mOffsets(rhs.mOffsets)
+    , mValues(rhs.mValues)
+    , mCompressedOffsetBytes(rhs.mCompressedOffsetBytes)
+    , mMutex()
+{
+    if (rhs.isCompressed()) {
+        mCompressedData.reset(new char[mCompressedBytes]);
+        std::memcpy(mCompressedData.get(), rhs.mCompressedData.get(), mCompressedBytes);
+        if (uncompress)     this->decompress();
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+VariableAttributeArray<ValueType_, Codec_>&
+VariableAttributeArray<ValueType_, Codec_>::operator=(const VariableAttributeArray& rhs)
+{
+    if (&rhs != this) {
+        tbb::spin_mutex::scoped_lock lock(mMutex);
+
+        mFlags = rhs.mFlags;
+        mCompressionSettings = rhs.mCompressionSettings;
+        mCompressedBytes = rhs.mCompressedBytes;
+        mCompressedStamp = rhs.mCompressedStamp;
+        mSize = rhs.mSize;
+        mValueCount = rhs.mValueCount;
+        mOffsets = rhs.mOffsets;
+        mValues = rhs.mValues;
+        mCompressedOffsetBytes = rhs.mCompressedOffsetBytes;
+
+        mCompressedData.reset();
+        if (rhs.isCompressed()) {
+            mCompressedData.reset(new char[mCompressedBytes]);
+            std::memcpy(mCompressedData.get(), rhs.mCompressedData.get(), mCompressedBytes);
+        }
+    }
+
+    return *this;
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline const NamePair&
+VariableAttributeArray<ValueType_, Codec_>::attributeType()
+{
+    if (sTypeName == NULL) {
+        NamePair* s = new NamePair(std::string(typeNameAsString<ValueType>()) + "[]", Codec::name());
+        if (sTypeName.compare_and_swap(s, NULL) != NULL) delete s;
+    }
+    return *sTypeName;
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline bool
+VariableAttributeArray<ValueType_, Codec_>::isRegistered()
+{
+    return AttributeArray::isRegistered(VariableAttributeArray::attributeType());
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline void
+VariableAttributeArray<ValueType_, Codec_>::registerType()
+{
+    AttributeArray::registerType(VariableAttributeArray::attributeType(), VariableAttributeArray::factory);
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline void
+VariableAttributeArray<ValueType_, Codec_>::unregisterType()
+{
+    AttributeArray::unregisterType(VariableAttributeArray::attributeType());
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline typename VariableAttributeArray<ValueType_, Codec_>::Ptr
+VariableAttributeArray<ValueType_, Codec_>::create(size_t n, Index)
+{
+    return Ptr(new VariableAttributeArray(n));
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline VariableAttributeArray<ValueType_, Codec_>&
+VariableAttributeArray<ValueType_, Codec_>::cast(AttributeArray& attributeArray)
+{
+    if (!attributeArray.isType<VariableAttributeArray>()) {
+        OPENVDB_THROW(TypeError, "Invalid Attribute Type");
+    }
+    return static_cast<VariableAttributeArray&>(attributeArray);
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline const VariableAttributeArray<ValueType_, Codec_>&
+VariableAttributeArray<ValueType_, Codec_>::cast(const AttributeArray& attributeArray)
+{
+    if (!attributeArray.isType<VariableAttributeArray>()) {
+        OPENVDB_THROW(TypeError, "Invalid Attribute Type");
+    }
+    return static_cast<const VariableAttributeArray&>(attributeArray);
+}
+
+
+template<typename ValueType_, typename Codec_>
+AttributeArray::Ptr
+VariableAttributeArray<ValueType_, Codec_>::copy() const
+{
+    return AttributeArray::Ptr(new VariableAttributeArray<ValueType, Codec>(*this));
+}
+
+
+template<typename ValueType_, typename Codec_>
+AttributeArray::Ptr
+VariableAttributeArray<ValueType_, Codec_>::copyUncompressed() const
+{
+    return AttributeArray::Ptr(new VariableAttributeArray<ValueType, Codec>(*this, /*decompress = */true));
+}
+
+
+template<typename ValueType_, typename Codec_>
+size_t
+VariableAttributeArray<ValueType_, Codec_>::memUsage() const
+{
+    return sizeof(*this) + mOffsets.capacity() * sizeof(Index) +
+        mValues.capacity() * sizeof(StorageType) + mCompressedBytes;
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline Index
+VariableAttributeArray<ValueType_, Codec_>::start(Index n) const
+{
+    // points beyond the stored offsets have no values
+
+    return n < mOffsets.size() ? mOffsets[n] : mValueCount;
+}
+
+
+template<typename ValueType_, typename Codec_>
+inline void
+VariableAttributeArray<ValueType_, Codec_>::doDecompress() const
+{
+    if (this->isCompressed())   const_cast<VariableAttributeArray*>(this)->decompress();
+}
+
+
+template<typename ValueType_, typename Codec_>
+Index
+VariableAttributeArray<ValueType_, Codec_>::count(Index n) const
+{
+    if (n >= mSize)                     OPENVDB_THROW(IndexError, "Out-of-range access.");
+    this->doDecompress();
+
+    return this->start(n + 1) - this->start(n);
+}
+
+
+template<typename ValueType_, typename Codec_>
+typename VariableAttributeArray<ValueType_, Codec_>::ValueType
+VariableAttributeArray<ValueType_, Codec_>::get(Index n, Index m) const
+{
+    if (m >= this->count(n))            OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    ValueType value;
+    Codec::decode(mValues[this->start(n) + m], value);
+    return value;
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::get(Index n, std::vector<ValueType>& values) const
+{
+    const Index count = this->count(n);
+    const Index offset = this->start(n);
+
+    values.resize(count);
+    for (Index i = 0; i < count; i++)   Codec::decode(mValues[offset + i], values[i]);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(Index n, Index m, const ValueType& value)
+{
+    if (m >= this->count(n))            OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    Codec::encode(value, mValues[this->start(n) + m]);
+}
+
+
+template<typename ValueType_, typename Codec_>
+Index
+VariableAttributeArray<ValueType_, Codec_>::resizeUnsafe(Index n, Index count)
+{
+    // this function expects the array to be uncompressed
+
+    assert(!this->isCompressed());
+
+    // append the offsets of any points without values that precede this one
+
+    if (n + 1 >= mOffsets.size()) {
+        if (count == 0)     return mValueCount;
+        mOffsets.resize(n + 2, mValueCount);
+    }
+
+    const Index start = mOffsets[n];
+    const Index end = mOffsets[n + 1];
+    const Index oldCount = end - start;
+
+    if (count == oldCount)  return start;
+
+    // resize the packed values in-place, values of subsequent points are only moved
+    // (and their offsets updated) if any subsequent point stores values
+
+    if (count > oldCount)   mValues.insert(mValues.begin() + end, count - oldCount, StorageType());
+    else                    mValues.erase(mValues.begin() + start + count, mValues.begin() + end);
+
+    for (size_t i = n + 1; i < mOffsets.size(); i++) {
+        mOffsets[i] = mOffsets[i] - oldCount + count;
+    }
+
+    mValueCount = mOffsets.back();
+
+    return start;
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(Index n, const ValueType* values, Index count)
+{
+    if (n >= mSize)                     OPENVDB_THROW(IndexError, "Out-of-range access.");
+    if (this->isCompressed())           this->decompress();
+
+    const Index offset = this->resizeUnsafe(n, count);
+
+    for (Index i = 0; i < count; i++)   Codec::encode(values[i], mValues[offset + i]);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(Index n, const std::vector<ValueType>& values)
+{
+    this->set(n, values.empty() ? NULL : &values[0], Index(values.size()));
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::setCounts(const std::vector<Index>& counts)
+{
+    if (counts.size() != mSize) {
+        OPENVDB_THROW(ValueError, "Number of counts does not match the size of the array.");
+    }
+
+    if (this->isCompressed())           this->decompress();
+
+    std::vector<Index> offsets(mSize + 1);
+    offsets[0] = 0;
+    for (size_t n = 0; n < mSize; n++)  offsets[n + 1] = offsets[n] + counts[n];
+
+    StorageType zero;
+    Codec::encode(zeroVal<ValueType>(), zero);
+
+    std::vector<StorageType> values(offsets.back(), zero);
+
+    for (Index n = 0; n < Index(mSize); n++) {
+        const Index count = std::min(counts[n], this->start(n + 1) - this->start(n));
+        std::copy(  mValues.begin() + this->start(n), mValues.begin() + this->start(n) + count,
+                    values.begin() + offsets[n]);
+    }
+
+    mValueCount = offsets.back();
+    mOffsets.swap(offsets);
+    mValues.swap(values);
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::set(const Index n, const AttributeArray& sourceArray, const Index sourceIndex)
+{
+    const VariableAttributeArray& source = VariableAttributeArray::cast(sourceArray);
+
+    const Index count = source.count(sourceIndex);
+
+    if (n >= mSize)                     OPENVDB_THROW(IndexError, "Out-of-range access.");
+    if (this->isCompressed())           this->decompress();
+
+    // copy the encoded values directly
+
+    const Index offset = this->resizeUnsafe(n, count);
+    const Index sourceOffset = source.start(sourceIndex);
+
+    for (Index i = 0; i < count; i++)   mValues[offset + i] = source.mValues[sourceOffset + i];
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::expand(bool /*fill*/)
+{
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::collapse()
+{
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+
+    mCompressedData.reset();
+    mCompressedStamp.reset();
+    mCompressedBytes = 0;
+    mCompressedOffsetBytes = 0;
+    mValueCount = 0;
+    std::vector<Index>().swap(mOffsets);
+    std::vector<StorageType>().swap(mValues);
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::compact()
+{
+    if (this->isCompressed())   return this->isUniform();
+
+    if (this->isUniform()) {
+        this->collapse();
+        return true;
+    }
+
+    // remove the offsets of trailing points without values and release unused capacity
+
+    size_t size = mOffsets.size();
+    while (size > 1 && mOffsets[size - 2] == mValueCount)    size--;
+
+    std::vector<Index>(mOffsets.begin(), mOffsets.begin() + size).swap(mOffsets);
+    std::vector<StorageType>(mValues).swap(mValues);
+
+    return false;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::compress()
+{
+    using attribute_compression::canCompress;
+    using attribute_compression::compress;
+
+    if (!canCompress())     return false;
+
+    if (this->isUniform() || this->isCompressed())  return false;
+
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+
+    size_t offsetBytes = 0, valueBytes = 0;
+
+    boost::scoped_array<char> offsetBuffer(compress(reinterpret_cast<const char*>(&mOffsets[0]),
+        sizeof(Index), mOffsets.size() * sizeof(Index), offsetBytes, mCompressionSettings));
+    if (!offsetBuffer)      return false;
+
+    boost::scoped_array<char> valueBuffer(compress(reinterpret_cast<const char*>(&mValues[0]),
+        sizeof(StorageType), mValues.size() * sizeof(StorageType), valueBytes, mCompressionSettings));
+    if (!valueBuffer)       return false;
+
+    mCompressedData.reset(new char[offsetBytes + valueBytes]);
+    std::memcpy(mCompressedData.get(), offsetBuffer.get(), offsetBytes);
+    std::memcpy(mCompressedData.get() + offsetBytes, valueBuffer.get(), valueBytes);
+
+    mCompressedOffsetBytes = offsetBytes;
+    mCompressedBytes = offsetBytes + valueBytes;
+    this->stampCompressedData();
+
+    std::vector<Index>().swap(mOffsets);
+    std::vector<StorageType>().swap(mValues);
+
+    return true;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::decompress()
+{
+    using attribute_compression::decompress;
+    using attribute_compression::uncompressedSize;
+
+    tbb::spin_mutex::scoped_lock lock(mMutex);
+
+    if (!this->isCompressed())  return false;
+
+    const char* offsetBuffer = mCompressedData.get();
+    const char* valueBuffer = offsetBuffer + mCompressedOffsetBytes;
+
+    // decompress directly into the offsets and values
+
+    std::vector<Index> offsets(uncompressedSize(offsetBuffer) / sizeof(Index));
+    std::vector<StorageType> values(mValueCount);
+
+    if (!decompress(offsetBuffer, reinterpret_cast<char*>(&offsets[0]), offsets.size() * sizeof(Index)) ||
+        !decompress(valueBuffer, reinterpret_cast<char*>(&values[0]), values.size() * sizeof(StorageType))) {
+        return false;
+    }
+
+    mOffsets.swap(offsets);
+    mValues.swap(values);
+
+    mCompressedData.reset();
+    mCompressedStamp.reset();
+    mCompressedBytes = 0;
+    mCompressedOffsetBytes = 0;
+
+    return true;
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::read(std::istream& is)
+{
+    using attribute_compression::decompress;
+
+    // read data
+
+    Index64 bytes = Index64(0);
+    is.read(reinterpret_cast<char*>(&bytes), sizeof(Index64));
+    bytes = bytes - /*flags*/sizeof(Int16) - /*size*/sizeof(Index64);
+
+    Int16 flags = Int16(0);
+    is.read(reinterpret_cast<char*>(&flags), sizeof(Int16));
+    mFlags = flags;
+
+    Index64 size = Index64(0);
+    is.read(reinterpret_cast<char*>(&size), sizeof(Index64));
+    mSize = size;
+
+    // clear uniform and compress flags
+
+    mFlags &= Int16(~WRITEUNIFORM & ~WRITEMEMCOMPRESS & ~WRITEDISKCOMPRESS);
+
+    this->collapse();
+
+    if (flags & WRITEUNIFORM)   return;
+
+    // read the value count, the number of offsets and the (possibly compressed) offset bytes
+
+    Index64 header[3];
+    is.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    const Index valueCount = Index(header[0]);
+    const size_t offsetCount = size_t(header[1]);
+    const size_t offsetBytes = size_t(header[2]);
+    const size_t valueBytes = size_t(bytes) - sizeof(header) - offsetBytes;
+
+    boost::scoped_array<char> buffer(new char[offsetBytes + valueBytes]);
+    is.read(buffer.get(), offsetBytes + valueBytes);
+
+    mValueCount = valueCount;
+
+    // compressed in-memory
+
+    if (flags & WRITEMEMCOMPRESS) {
+        mCompressedData.swap(buffer);
+        mCompressedOffsetBytes = offsetBytes;
+        mCompressedBytes = offsetBytes + valueBytes;
+        this->stampCompressedData();
+        return;
+    }
+
+    mOffsets.resize(offsetCount);
+    mValues.resize(valueCount);
+
+    char* offsetData = reinterpret_cast<char*>(&mOffsets[0]);
+    char* valueData = reinterpret_cast<char*>(&mValues[0]);
+
+    // compressed on-disk
+
+    if (flags & WRITEDISKCOMPRESS) {
+        if (!decompress(buffer.get(), offsetData, offsetCount * sizeof(Index)) ||
+            !decompress(buffer.get() + offsetBytes, valueData, valueCount * sizeof(StorageType))) {
+            OPENVDB_THROW(IoError, "Unable to decompress variable attribute array.");
+        }
+    }
+    else {
+        std::memcpy(offsetData, buffer.get(), offsetBytes);
+        std::memcpy(valueData, buffer.get() + offsetBytes, valueBytes);
+    }
+}
+
+
+template<typename ValueType_, typename Codec_>
+void
+VariableAttributeArray<ValueType_, Codec_>::write(std::ostream& os, bool outputTransient) const
+{
+    using attribute_compression::compress;
+
+    if (!outputTransient && this->isTransient())    return;
+
+    Int16 flags(mFlags);
+    Index64 size(mSize);
+
+    Index64 header[3] = { Index64(mValueCount), Index64(mOffsets.size()), Index64(0) };
+
+    boost::scoped_array<char> offsetBuffer, valueBuffer;
+    const char* offsetData = NULL;
+    const char* valueData = NULL;
+    size_t offsetBytes = 0, valueBytes = 0;
+
+    if (this->isUniform())
+    {
+        flags |= WRITEUNIFORM;
+    }
+    else if (this->isCompressed())
+    {
+        flags |= WRITEMEMCOMPRESS;
+        offsetData = mCompressedData.get();
+        valueData = offsetData + mCompressedOffsetBytes;
+        offsetBytes = mCompressedOffsetBytes;
+        valueBytes = mCompressedBytes - mCompressedOffsetBytes;
+    }
+    else
+    {
+        offsetData = reinterpret_cast<const char*>(&mOffsets[0]);
+        valueData = reinterpret_cast<const char*>(&mValues[0]);
+        offsetBytes = mOffsets.size() * sizeof(Index);
+        valueBytes = mValues.size() * sizeof(StorageType);
+
+        if (io::getDataCompression(os) & io::COMPRESS_BLOSC)
+        {
+            size_t compressedOffsetBytes = 0, compressedValueBytes = 0;
+            offsetBuffer.reset(compress(offsetData, sizeof(Index), offsetBytes,
+                compressedOffsetBytes, mCompressionSettings));
+            valueBuffer.reset(compress(valueData, sizeof(StorageType), valueBytes,
+                compressedValueBytes, mCompressionSettings));
+
+            if (offsetBuffer && valueBuffer) {
+                flags |= WRITEDISKCOMPRESS;
+                offsetData = offsetBuffer.get();
+                valueData = valueBuffer.get();
+                offsetBytes = compressedOffsetBytes;
+                valueBytes = compressedValueBytes;
+            }
+        }
+    }
+
+    Index64 bytes = /*flags*/ sizeof(Int16) + /*size*/ sizeof(Index64);
+
+    if (!this->isUniform())     bytes += sizeof(header) + offsetBytes + valueBytes;
+
+    header[2] = Index64(offsetBytes);
+
+    // write data
+
+    os.write(reinterpret_cast<const char*>(&bytes), sizeof(Index64));
+    os.write(reinterpret_cast<const char*>(&flags), sizeof(Int16));
+    os.write(reinterpret_cast<const char*>(&size), sizeof(Index64));
+
+    if (this->isUniform())      return;
+
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+    os.write(offsetData, offsetBytes);
+    os.write(valueData, valueBytes);
+}
+
+
+template<typename ValueType_, typename Codec_>
+const AttributeArray::AccessorBase&
+VariableAttributeArray<ValueType_, Codec_>::getAccessor() const
+{
+    // handles for fixed-stride attributes cannot be bound to this array,
+    // VariableAttributeHandles access the values directly instead
+
+    static const AttributeArray::AccessorBase accessor = AttributeArray::AccessorBase();
+    return accessor;
+}
+
+
+template<typename ValueType_, typename Codec_>
+bool
+VariableAttributeArray<ValueType_, Codec_>::isEqual(const AttributeArray& other) const
+{
+    const VariableAttributeArray* const otherT = dynamic_cast<const VariableAttributeArray*>(&other);
+    if (!otherT)    return false;
+    if (mSize != otherT->mSize || mValueCount != otherT->mValueCount)   return false;
+
+    this->doDecompress();
+    otherT->doDecompress();
+
+    for (Index n = 0; n < Index(mSize); n++) {
+        if (this->start(n) != otherT->start(n))     return false;
+    }
+
+    for (Index i = 0; i < mValueCount; i++) {
+        if (!math::isExactlyEqual(mValues[i], otherT->mValues[i]))  return false;
+    }
+
+    return true;
+}
+
+
+////////////////////////////////////////
+
+// VariableAttributeHandle implementation
+
+template <typename ValueType, typename CodecType>
+typename VariableAttributeHandle<ValueType, CodecType>::Ptr
+VariableAttributeHandle<ValueType, CodecType>::create(const AttributeArray& array, const bool preserveCompression)
+{
+    return Ptr(new Handle(array, preserveCompression));
+}
+
+template <typename ValueType, typename CodecType>
+VariableAttributeHandle<ValueType, CodecType>::VariableAttributeHandle(const AttributeArray& array, const bool preserveCompression)
+    : mArray(&ArrayType::cast(array))
+{
+    // if array is compressed and preserve compression is true, decompress into
+    // a local copy that is destroyed with handle to maintain thread-safety
+
+    if (array.isCompressed())
+    {
+        if (preserveCompression) {
+            mLocalArray = array.copyUncompressed();
+            mArray = &ArrayType::cast(*mLocalArray);
+        }
+        else {
+            const_cast<AttributeArray&>(array).decompress();
+        }
+    }
+}
+
+
+////////////////////////////////////////
+
+// VariableAttributeWriteHandle implementation
+
+template <typename ValueType, typename CodecType>
+typename VariableAttributeWriteHandle<ValueType, CodecType>::Ptr
+VariableAttributeWriteHandle<ValueType, CodecType>::create(AttributeArray& array)
+{
+    return Ptr(new Handle(array));
+}
+
+template <typename ValueType, typename CodecType>
+VariableAttributeWriteHandle<ValueType, CodecType>::VariableAttributeWriteHandle(AttributeArray& array)
+    : VariableAttributeHandle<ValueType, CodecType>(array, /*preserveCompression = */ false)
+{
+}
+
+
+} // namespace tools
+
+} // namespace OPENVDB_VERSION_NAME
+} // namespace openvdb
+
+
+#endif // OPENVDB_TOOLS_ATTRIBUTE_ARRAY_VARIABLE_HAS_BEEN_INCLUDED
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -35,6 +35,12 @@
 
 #include <openvdb_points/tools/AttributeGroup.h>
 
+#include <openvdb/util/NodeMasks.h> // for util::CountOn
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
@@ -47,8 +53,37 @@ namespace tools {
 // GroupHandle implementation
 
 
-GroupHandle::GroupHandle(const GroupAttributeArray& array, const GroupType& offset)
-        : mArray(array)
+namespace {
+
+/// Return a bitmask with bit i set if all bits of @a bitMask are on in @a values[i]
+Index64 membershipBits(const GroupType* values, Index count, GroupType bitMask)
+{
+    Index64 bits(0);
+    Index i = 0;
+
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(bitMask));
+    for (; i + 16 <= count; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        const __m128i on = _mm_cmpeq_epi8(_mm_and_si128(v, mask), mask);
+        bits |= Index64(static_cast<uint16_t>(_mm_movemask_epi8(on))) << i;
+    }
+#endif
+
+    for (; i < count; i++) {
+        if ((values[i] & bitMask) == bitMask)   bits |= Index64(1) << i;
+    }
+
+    return bits;
+}
+
+} // namespace
+
+
+GroupHandle::GroupHandle(const GroupAttributeArray& array, const GroupType& offset,
+            const bool preserveCompression)
+        : mLocalArray()
+        , mArray(prepareArray(array, preserveCompression, mLocalArray))
         , mBitMask(GroupType(1) << offset)
 {
     assert(isGroup(mArray));
@@ -56,17 +91,106 @@ GroupHandle::GroupHandle(const GroupAttributeArray& array, const GroupType& offs
 
 
 GroupHandle::GroupHandle(const GroupAttributeArray& array, const GroupType& bitMask,
-            BitMask)
-    : mArray(array)
+            BitMask, const bool preserveCompression)
+    : mLocalArray()
+    , mArray(prepareArray(array, preserveCompression, mLocalArray))
     , mBitMask(bitMask)
 {
     assert(isGroup(mArray));
 }
 
 
+const GroupAttributeArray&
+GroupHandle::prepareArray(const GroupAttributeArray& array, const bool preserveCompression,
+    AttributeArray::Ptr& localArray)
+{
+    // load the array so that the unsafe accessors can be used
+
+    array.loadData();
+
+    if (!array.isCompressed())  return array;
+
+    // read-only handles decompress into a local copy so that the shared array is
+    // never modified, the copy may be shared with the calling thread's cache of
+    // recent decompressions but is never modified either
+
+    if (preserveCompression) {
+        localArray = array.cachedCopyUncompressed();
+        if (!localArray->isCompressed())    return GroupAttributeArray::cast(*localArray);
+        localArray.reset();
+    }
+
+    const_cast<GroupAttributeArray&>(array).decompress();
+    return array;
+}
+
+
 bool GroupHandle::get(Index n) const
 {
-    return (mArray.get(n) & mBitMask) == mBitMask;
+    if (n >= mArray.size())     OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    return this->getUnsafe(n);
+}
+
+
+Index64 GroupHandle::getWord(Index word) const
+{
+    const Index size = Index(mArray.size());
+    const Index start = word << 6;
+
+    if (start >= size)          return Index64(0);
+
+    const Index count = std::min(size - start, Index(64));
+
+    // a uniform array holds the same membership for every index
+
+    if (mArray.isUniform()) {
+        if ((mArray.getUnsafe(0) & mBitMask) != mBitMask)   return Index64(0);
+        return count == 64 ? ~Index64(0) : (Index64(1) << count) - 1;
+    }
+
+    GroupType values[64];
+    mArray.getRangeUnsafe(start, count, values);
+
+    return membershipBits(values, count, mBitMask);
+}
+
+
+Index64 GroupHandle::memberCount() const
+{
+    const Membership summary = this->membership();
+
+    if (summary == NO_MEMBERS)          return 0;
+    else if (summary == ALL_MEMBERS)    return Index64(mArray.size());
+
+    Index64 count(0);
+    for (Index word = 0, words = this->wordCount(); word < words; word++) {
+        count += util::CountOn(this->getWord(word));
+    }
+    return count;
+}
+
+
+GroupHandle::Membership GroupHandle::membership() const
+{
+    if (mArray.size() == 0)     return NO_MEMBERS;
+
+    GroupType anyBits, allBits;
+    mArray.bitSummary(anyBits, allBits);
+
+    if ((allBits & mBitMask) == mBitMask)   return ALL_MEMBERS;
+
+    // a single bit is a member of some index if it is on in any value, otherwise
+    // membership of a bitmask of several groups requires testing the indices
+
+    if ((anyBits & mBitMask) != mBitMask)   return NO_MEMBERS;
+    if ((mBitMask & (mBitMask - 1)) == 0)   return SOME_MEMBERS;
+
+    for (Index word = 0, words = this->wordCount(); word < words; word++) {
+        if (this->getWord(word) != 0)       return SOME_MEMBERS;
+    }
+
+    return NO_MEMBERS;
 }
 
 
@@ -76,7 +200,7 @@ bool GroupHandle::get(Index n) const
 
 
 GroupWriteHandle::GroupWriteHandle(GroupAttributeArray& array, const GroupType& offset)
-    : GroupHandle(array, offset)
+    : GroupHandle(array, offset, /*preserveCompression=*/false)
 {
     assert(isGroup(mArray));
 }
@@ -93,11 +217,41 @@ void GroupWriteHandle::set(Index n, bool on)
 }
 
 
+void GroupWriteHandle::setWord(Index word, Index64 bits)
+{
+    const Index size = Index(mArray.size());
+    const Index start = word << 6;
+
+    if (start >= size)          OPENVDB_THROW(IndexError, "Out-of-range access.");
+
+    const Index count = std::min(size - start, Index(64));
+    const Index64 mask = count == 64 ? ~Index64(0) : (Index64(1) << count) - 1;
+
+    // avoid expanding a uniform array when the membership is unchanged
+
+    if ((this->getWord(word) ^ bits) & mask) {
+        GroupAttributeArray& array(const_cast<GroupAttributeArray&>(mArray));
+
+        GroupType values[64];
+        array.getRange(start, count, values);
+
+        for (Index i = 0; i < count; i++) {
+            if ((bits >> i) & Index64(1))   values[i] |= mBitMask;
+            else                            values[i] &= ~mBitMask;
+        }
+
+        array.setRange(start, count, values);
+    }
+}
+
+
 bool GroupWriteHandle::collapse(bool on)
 {
     GroupAttributeArray& array(const_cast<GroupAttributeArray&>(mArray));
 
-    array.compact();
+    // the array is about to be rewritten, so it is only made uniform, never sparse
+
+    array.compactUniform();
 
     if (this->isUniform()) {
         if (on)     array.collapse(array.get(0) | mBitMask);
@@ -105,9 +259,12 @@ bool GroupWriteHandle::collapse(bool on)
         return true;
     }
 
-    for (size_t i = 0; i < array.size(); i++) {
-        if (on)     array.set(i, array.get(i) | mBitMask);
-        else        array.set(i, array.get(i) & ~mBitMask);
+    // set the membership of 64 indices at a time rather than of each index
+
+    const Index64 bits = on ? ~Index64(0) : Index64(0);
+
+    for (Index word = 0, words = this->wordCount(); word < words; word++) {
+        this->setWord(word, bits);
     }
 
     return false;
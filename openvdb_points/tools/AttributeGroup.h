@@ -41,6 +41,9 @@
 
 #include <openvdb_points/tools/AttributeArray.h>
 
+#include <boost/optional.hpp>
+#include <boost/utility/in_place_factory.hpp>
+
 
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
@@ -110,17 +113,56 @@ public:
 
     typedef std::pair<size_t, uint8_t> GroupIndex;
 
-    GroupHandle(const GroupAttributeArray& array, const GroupType& offset);
-    GroupHandle(const GroupAttributeArray& array, const GroupType& bitMask, BitMask);
+    /// Summary of the group membership of all indices
+    enum Membership { NO_MEMBERS = 0, SOME_MEMBERS, ALL_MEMBERS };
+
+    /// @brief Bind a handle to the group at @a offset of a group attribute array.
+    /// @details If the array is compressed and @a preserveCompression is true, the handle
+    /// reads an uncompressed copy (shared with the calling thread's cache of recent
+    /// decompressions), otherwise the array itself is decompressed.
+    GroupHandle(const GroupAttributeArray& array, const GroupType& offset,
+                const bool preserveCompression = true);
+    GroupHandle(const GroupAttributeArray& array, const GroupType& bitMask, BitMask,
+                const bool preserveCompression = true);
 
     size_t size() const { return mArray.size(); }
     bool isUniform() const { return mArray.isUniform(); }
 
     bool get(Index n) const;
 
+    /// @brief Return group membership of index @a n without bounds checking.
+    /// @note The array is loaded, and decompressed or copied uncompressed, on construction
+    /// of the handle.
+    bool getUnsafe(Index n) const { return (mArray.getUnsafe(n) & mBitMask) == mBitMask; }
+
+    /// Return the number of 64-bit words needed to hold the membership of every index
+    Index wordCount() const { return Index((mArray.size() + 63) >> 6); }
+
+    /// @brief Return the membership of the 64 indices from 64 * @a word onwards as a bitmask,
+    /// the lowest bit being the first index. Bits beyond the end of the array are zero.
+    Index64 getWord(Index word) const;
+
+    /// Return the number of indices that are members of this group
+    Index64 memberCount() const;
+
+    /// @brief Return whether none, some or all of the indices are members of this group.
+    /// @note The summary is cached by the array until it is next modified, so this is
+    /// constant time for unmodified arrays.
+    Membership membership() const;
+
 protected:
+    // local uncompressed copy of a compressed array (to preserve compression), this
+    // is declared first as it must be initialized before the array reference
+    AttributeArray::Ptr mLocalArray;
+
     const GroupAttributeArray& mArray;
     const GroupType mBitMask;
+
+private:
+    /// Load the array and return the array to read from, either the array itself
+    /// (decompressed unless preserving compression) or an uncompressed copy
+    static const GroupAttributeArray& prepareArray(const GroupAttributeArray& array,
+        const bool preserveCompression, AttributeArray::Ptr& localArray);
 }; // class GroupHandle
 
 
@@ -136,6 +178,10 @@ public:
 
     void set(Index n, bool on);
 
+    /// @brief Set the membership of the 64 indices from 64 * @a word onwards from a bitmask
+    /// as returned by getWord(). Bits beyond the end of the array are ignored.
+    void setWord(Index word, Index64 bits);
+
     /// @brief Set membership for the whole array and attempt to collapse
     ///
     /// @param on True or false for inclusion in group
@@ -166,18 +212,19 @@ public:
 
     template <typename LeafT>
     void reset(const LeafT& leaf) {
-        mHandle.reset(new GroupHandle(leaf.groupHandle(mAttribute)));
+        mHandle.reset();
+        mHandle = boost::in_place(leaf.groupHandle(mAttribute));
     }
 
     template <typename IterT>
     bool valid(const IterT& iter) const {
         assert(mHandle);
-        return mHandle->get(*iter);
+        return mHandle->getUnsafe(*iter);
     }
 
 private:
     const Name mAttribute;
-    GroupHandle::Ptr mHandle;
+    boost::optional<GroupHandle> mHandle;
 }; // class GroupFilter
 
 
@@ -38,6 +38,8 @@
 #include <openvdb_points/tools/AttributeSet.h>
 
 #include <algorithm> // std::equal
+#include <ios> // std::ios_base::xalloc
+#include <limits> // std::numeric_limits
 #include <string>
 
 #include <boost/algorithm/string/predicate.hpp> // boost::starts_with
@@ -77,6 +79,64 @@ namespace {
             vec.erase(vec.begin() + (*it));
         }
     }
+
+    // tokens written in place of the descriptor array length to mark a full descriptor
+    // (followed by the format version) or a reference to the descriptor previously written
+    // to the same stream, these can never be valid array lengths so unversioned streams
+    // (which begin with the array length) can still be read
+    const Index64 sDescriptorFullToken = std::numeric_limits<Index64>::max();
+    const Index64 sDescriptorReferenceToken = std::numeric_limits<Index64>::max() - 1;
+
+    // indices into the stream pword arrays used to store the descriptor most recently
+    // read from or written to a stream, this allows descriptors to be written once per grid
+    // and identical descriptors to be shared on read, the iword arrays at the same indices
+    // store the format version most recently read and whether references may be written
+    const int sDescriptorStreamIndex = std::ios_base::xalloc();
+    const int sDescriptorWriteStreamIndex = std::ios_base::xalloc();
+
+    void descriptorStreamCallback(std::ios_base::event event, std::ios_base& stream, int index)
+    {
+        if (index != sDescriptorStreamIndex &&
+            index != sDescriptorWriteStreamIndex)    return;
+
+        void*& ptr = stream.pword(index);
+
+        if (!ptr)   return;
+
+        if (event == std::ios_base::erase_event) {
+            delete static_cast<AttributeSet::DescriptorPtr*>(ptr);
+            ptr = NULL;
+        }
+        else if (event == std::ios_base::copyfmt_event) {
+            // the pointer has been shallow-copied from another stream so take a new reference
+            ptr = new AttributeSet::DescriptorPtr(*static_cast<AttributeSet::DescriptorPtr*>(ptr));
+        }
+    }
+
+    // return the descriptor stored on this stream at the given index (null if none)
+    AttributeSet::DescriptorPtr& streamDescriptor(std::ios_base& stream, int index)
+    {
+        void*& ptr = stream.pword(index);
+
+        if (!ptr) {
+            stream.register_callback(descriptorStreamCallback, index);
+            ptr = new AttributeSet::DescriptorPtr();
+        }
+
+        return *static_cast<AttributeSet::DescriptorPtr*>(ptr);
+    }
+
+    // return the descriptor most recently read from this stream if it matches the
+    // given descriptor, otherwise store the given descriptor on the stream and return it
+    AttributeSet::DescriptorPtr shareDescriptor(std::istream& is, const AttributeSet::DescriptorPtr& descr)
+    {
+        AttributeSet::DescriptorPtr& previous = streamDescriptor(is, sDescriptorStreamIndex);
+
+        if (previous && *previous == *descr)    return previous;
+
+        previous = descr;
+        return descr;
+    }
 }
 
 ////////////////////////////////////////
@@ -470,7 +530,71 @@ AttributeSet::write(std::ostream& os, bool outputTransient) const
 void
 AttributeSet::readMetadata(std::istream& is)
 {
-    mDescr->read(is);
+    Index64 token = 0;
+    is.read(reinterpret_cast<char*>(&token), sizeof(Index64));
+
+    long& version = is.iword(sDescriptorStreamIndex);
+
+    // reuse the descriptor previously read from this stream, references are only
+    // written after a versioned descriptor
+
+    if (token == sDescriptorReferenceToken) {
+        const DescriptorPtr& previous = streamDescriptor(is, sDescriptorStreamIndex);
+        if (version < FORMAT_SHARED_DESCRIPTORS || !previous) {
+            OPENVDB_THROW(IoError, "Attribute descriptor reference found with no previous descriptor.");
+        }
+        mDescr = previous;
+        return;
+    }
+
+    DescriptorPtr descr(new Descriptor);
+
+    if (token == sDescriptorFullToken) {
+        Index32 format = 0;
+        is.read(reinterpret_cast<char*>(&format), sizeof(Index32));
+        if (format == FORMAT_UNVERSIONED || format > FORMAT_CURRENT) {
+            OPENVDB_THROW(IoError, "Unsupported attribute descriptor format version " << format << ".");
+        }
+        version = long(format);
+        descr->read(is);
+    }
+    else {
+        // unversioned descriptors cannot follow a versioned descriptor in the same grid
+
+        if (version != FORMAT_UNVERSIONED) {
+            OPENVDB_THROW(IoError, "Invalid attribute descriptor token " << token << ".");
+        }
+        descr->read(is, /*arraylength=*/token);
+    }
+
+    // share the descriptor with the attribute set previously read from this stream
+    // if they are identical (typically all the leaf nodes in a grid)
+
+    mDescr = shareDescriptor(is, descr);
+}
+
+
+void
+AttributeSet::resetDescriptorStream(std::istream& is)
+{
+    is.iword(sDescriptorStreamIndex) = FORMAT_UNVERSIONED;
+
+    if (is.pword(sDescriptorStreamIndex)) {
+        streamDescriptor(is, sDescriptorStreamIndex).reset();
+    }
+}
+
+
+void
+AttributeSet::resetDescriptorStream(std::ostream& os)
+{
+    // descriptors written to this stream may now be written as references
+
+    os.iword(sDescriptorWriteStreamIndex) = 1;
+
+    if (os.pword(sDescriptorWriteStreamIndex)) {
+        streamDescriptor(os, sDescriptorWriteStreamIndex).reset();
+    }
 }
 
 
@@ -491,15 +615,30 @@ AttributeSet::writeMetadata(std::ostream& os, bool outputTransient) const
         }
     }
 
-    // write out a descriptor without transient attributes
+    // use a descriptor without transient attributes
 
-    if (transientArrays.empty()) {
-        mDescr->write(os);
-    }
-    else {
-        Descriptor::Ptr descr = mDescr->duplicateDrop(transientArrays);
-        descr->write(os);
+    DescriptorPtr descr = mDescr;
+    if (!transientArrays.empty())   descr = mDescr->duplicateDrop(transientArrays);
+
+    // write a reference if the descriptor matches the one previously written to
+    // this stream, otherwise write out the format version and the full descriptor
+
+    if (os.iword(sDescriptorWriteStreamIndex)) {
+        DescriptorPtr& previous = streamDescriptor(os, sDescriptorWriteStreamIndex);
+
+        if (previous && (previous == descr || *previous == *descr)) {
+            os.write(reinterpret_cast<const char*>(&sDescriptorReferenceToken), sizeof(Index64));
+            return;
+        }
+
+        previous = descr;
     }
+
+    const Index32 format = FORMAT_CURRENT;
+
+    os.write(reinterpret_cast<const char*>(&sDescriptorFullToken), sizeof(Index64));
+    os.write(reinterpret_cast<const char*>(&format), sizeof(Index32));
+    descr->write(os);
 }
 
 
@@ -1011,6 +1150,13 @@ AttributeSet::Descriptor::read(std::istream& is)
     Index64 arraylength = 0;
     is.read(reinterpret_cast<char*>(&arraylength), sizeof(Index64));
 
+    this->read(is, arraylength);
+}
+
+
+void
+AttributeSet::Descriptor::read(std::istream& is, Index64 arraylength)
+{
     std::vector<NamePair>(size_t(arraylength)).swap(mTypes);
 
     for(Index64 n = 0; n < arraylength; ++n) {
@@ -69,6 +69,16 @@ class AttributeSet
 public:
     enum { INVALID_POS = boost::integer_traits<size_t>::const_max };
 
+    /// @brief Versions of the stream format of the attribute descriptor, written with each
+    /// descriptor that is written in full.
+    enum FormatVersion {
+        /// descriptor written in full by every attribute set, with no version
+        FORMAT_UNVERSIONED = 0,
+        /// descriptor written in full once per grid and referenced by later attribute sets
+        FORMAT_SHARED_DESCRIPTORS = 1,
+        FORMAT_CURRENT = FORMAT_SHARED_DESCRIPTORS
+    };
+
     typedef boost::shared_ptr<AttributeSet> Ptr;
     typedef boost::shared_ptr<const AttributeSet> ConstPtr;
 
@@ -221,12 +231,30 @@ public:
     /// @param outputTransient if true, write out transient attributes
     void write(std::ostream&, bool outputTransient = false) const;
 
-    /// This will read the attribute descriptor from a stream, but no attribute data.
+    /// @brief This will read the attribute descriptor from a stream, but no attribute data.
+    /// @note  If the descriptor is identical to the one most recently read from the same
+    ///        stream, the existing descriptor will be shared instead.
+    /// @throw IoError if the descriptor was written with an unsupported format version, or
+    ///        is a reference without a preceding versioned descriptor since the stream was
+    ///        last reset.
     void readMetadata(std::istream&);
-    /// This will write the attribute descriptor to a stream, but no attribute data.
+    /// @brief This will write the attribute descriptor to a stream, but no attribute data.
     /// @param outputTransient if true, write out transient attributes
+    /// @note  If resetDescriptorStream() has been called on the stream and the descriptor is
+    ///        identical to the one most recently written to it, only a reference to that
+    ///        descriptor is written, otherwise it is written in full with the format version.
     void writeMetadata(std::ostream&, bool outputTransient = false) const;
 
+    /// @brief Forget the descriptor most recently read from a stream, so that the next
+    /// descriptor must be read in full and may be either versioned or unversioned.
+    /// @note  Called at the start of each grid so that grids can be read independently.
+    static void resetDescriptorStream(std::istream&);
+    /// @brief Forget the descriptor most recently written to a stream and allow descriptors
+    /// subsequently written to it to be written as references to the previous descriptor.
+    /// @note  Called at the start of each grid so that grids can be read independently,
+    ///        descriptors are always written in full to streams on which it is not called.
+    static void resetDescriptorStream(std::ostream&);
+
     /// Read attribute data from a stream.
     void readAttributes(std::istream&);
     /// Write attribute data to a stream.
@@ -373,6 +401,9 @@ public:
     void write(std::ostream&) const;
     /// Unserialize this transform from the given stream.
     void read(std::istream&);
+    /// Unserialize this transform from the given stream, where the array length has
+    /// already been read.
+    void read(std::istream&, Index64 arraylength);
 
 protected:
     /// Append to a vector of names and types from this Descriptor in position order
@@ -51,7 +51,8 @@
 #include <openvdb_points/tools/AttributeArray.h>
 #include <openvdb_points/tools/AttributeGroup.h>
 
-#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/optional.hpp>
+#include <boost/utility/in_place_factory.hpp>
 
 class TestIndexFilter;
 
@@ -107,12 +108,13 @@ class MultiGroupFilter
 {
 public:
     typedef std::vector<Name> NameVector;
-    typedef boost::ptr_vector<GroupHandle> HandleVector;
+    typedef std::vector<GroupHandle> HandleVector;
 
     MultiGroupFilter(   const NameVector& include,
                         const NameVector& exclude)
         : mInclude(include)
         , mExclude(exclude)
+        , mNoneValid(false)
         , mInitialized(false) { }
 
     MultiGroupFilter(   const MultiGroupFilter& filter)
@@ -120,6 +122,7 @@ public:
         , mExclude(filter.mExclude)
         , mIncludeHandles(filter.mIncludeHandles)
         , mExcludeHandles(filter.mExcludeHandles)
+        , mNoneValid(filter.mNoneValid)
         , mInitialized(filter.mInitialized) { }
 
     inline bool initialized() const { return mInitialized; }
@@ -128,15 +131,32 @@ public:
     void reset(const LeafT& leaf) {
         mIncludeHandles.clear();
         mExcludeHandles.clear();
+        mNoneValid = false;
+
+        // groups with no members or all members in this leaf are resolved here
+        // instead of being tested for each index
+
+        bool includeGroups = false;
+        bool includeAll = false;
         for (NameVector::const_iterator it = mInclude.begin(),
                                         itEnd = mInclude.end(); it != itEnd; ++it) {
             if (!leaf.attributeSet().descriptor().hasGroup(*it))    continue;
-            mIncludeHandles.push_back(new GroupHandle(leaf.groupHandle(*it)));
+            includeGroups = true;
+            GroupHandle handle = leaf.groupHandle(*it);
+            const GroupHandle::Membership membership = handle.membership();
+            if (membership == GroupHandle::ALL_MEMBERS)         includeAll = true;
+            else if (membership == GroupHandle::SOME_MEMBERS)   mIncludeHandles.push_back(handle);
         }
+        if (includeAll)     mIncludeHandles.clear();
+        else if (includeGroups && mIncludeHandles.empty())      mNoneValid = true;
+
         for (NameVector::const_iterator     it = mExclude.begin(),
                                             itEnd = mExclude.end(); it != itEnd; ++it) {
             if (!leaf.attributeSet().descriptor().hasGroup(*it))    continue;
-            mExcludeHandles.push_back(new GroupHandle(leaf.groupHandle(*it)));
+            GroupHandle handle = leaf.groupHandle(*it);
+            const GroupHandle::Membership membership = handle.membership();
+            if (membership == GroupHandle::ALL_MEMBERS)         mNoneValid = true;
+            else if (membership == GroupHandle::SOME_MEMBERS)   mExcludeHandles.push_back(handle);
         }
         mInitialized = true;
     }
@@ -144,11 +164,12 @@ public:
     template <typename IterT>
     bool valid(const IterT& iter) const {
         assert(mInitialized);
+        if (mNoneValid)             return false;
         // accept no include filters as valid
         bool includeValid = mIncludeHandles.size() == 0;
         for (HandleVector::const_iterator   it = mIncludeHandles.begin(),
                                             itEnd = mIncludeHandles.end(); it != itEnd; ++it) {
-            if (it->get(*iter)) {
+            if (it->getUnsafe(*iter)) {
                 includeValid = true;
                 break;
             }
@@ -156,7 +177,7 @@ public:
         if (!includeValid)          return false;
         for (HandleVector::const_iterator   it = mExcludeHandles.begin(),
                                             itEnd = mExcludeHandles.end(); it != itEnd; ++it) {
-            if (it->get(*iter))     return false;
+            if (it->getUnsafe(*iter))     return false;
         }
         return true;
     }
@@ -166,6 +187,7 @@ private:
     const NameVector mExclude;
     HandleVector mIncludeHandles;
     HandleVector mExcludeHandles;
+    bool mNoneValid;
     bool mInitialized;
 }; // class MultiGroupFilter
 
@@ -283,16 +305,15 @@ public:
         : mIndex(filter.mIndex)
         , mFactor(filter.mFactor)
         , mSeed(filter.mSeed)
-    {
-        if (filter.mIdHandle)   mIdHandle.reset(new Handle(*filter.mIdHandle));
-    }
+        , mIdHandle(filter.mIdHandle) { }
 
     inline bool initialized() const { return bool(mIdHandle); }
 
     template <typename LeafT>
     void reset(const LeafT& leaf) {
         assert(leaf.hasAttribute(mIndex));
-        mIdHandle.reset(new Handle(leaf.constAttributeArray(mIndex)));
+        mIdHandle.reset();
+        mIdHandle = boost::in_place(leaf.constAttributeArray(mIndex));
     }
 
     template <typename IterT>
@@ -309,7 +330,7 @@ private:
     const size_t mIndex;
     const double mFactor;
     const unsigned int mSeed;
-    typename Handle::ScopedPtr mIdHandle;
+    boost::optional<Handle> mIdHandle;
 }; // class AttributeHashFilter
 
 
@@ -336,15 +357,14 @@ public:
         , mTransform(filter.mTransform)
         , mMin(filter.mMin)
         , mMax(filter.mMax)
-    {
-        if (filter.mPositionHandle)    mPositionHandle.reset(new Handle(*filter.mPositionHandle));
-    }
+        , mPositionHandle(filter.mPositionHandle) { }
 
     inline bool initialized() const { return bool(mPositionHandle); }
 
     template <typename LeafT>
     void reset(const LeafT& leaf) {
-        mPositionHandle.reset(new Handle(leaf.constAttributeArray("P")));
+        mPositionHandle.reset();
+        mPositionHandle = boost::in_place(leaf.constAttributeArray("P"));
     }
 
     template <typename IterT>
@@ -378,7 +398,7 @@ private:
     const math::Transform& mTransform;
     const ValueT mMin;
     const ValueT mMax;
-    Handle::ScopedPtr mPositionHandle;
+    boost::optional<Handle> mPositionHandle;
 }; // class LevelSetFilter
 
 
@@ -396,15 +416,14 @@ public:
     BBoxFilter(const BBoxFilter& filter)
         : mTransform(filter.mTransform)
         , mBbox(filter.mBbox)
-    {
-        if (filter.mPositionHandle)     mPositionHandle.reset(new Handle(*filter.mPositionHandle));
-    }
+        , mPositionHandle(filter.mPositionHandle) { }
 
     inline bool initialized() const { return bool(mPositionHandle); }
 
     template <typename LeafT>
     void reset(const LeafT& leaf) {
-        mPositionHandle.reset(new Handle(leaf.constAttributeArray("P")));
+        mPositionHandle.reset();
+        mPositionHandle = boost::in_place(leaf.constAttributeArray("P"));
     }
 
     template <typename IterT>
@@ -426,7 +445,7 @@ public:
 private:
     const openvdb::math::Transform& mTransform;
     const openvdb::BBoxd mBbox;
-    Handle::ScopedPtr mPositionHandle;
+    boost::optional<Handle> mPositionHandle;
 }; // class BBoxFilter
 
 
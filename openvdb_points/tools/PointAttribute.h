@@ -173,6 +173,18 @@ template <typename PointDataTree>
 inline void bloscCompressAttribute( PointDataTree& tree,
                                     const Name& name);
 
+/// @brief Apply Blosc compression to one attribute in the VDB tree using the given settings.
+///
+/// @param tree          the PointDataTree.
+/// @param name          name of the attribute to compress.
+/// @param settings      the Blosc settings to store on the attribute and compress with.
+///
+/// @note The settings are also used when writing the attribute with Blosc compression.
+template <typename PointDataTree>
+inline void bloscCompressAttribute( PointDataTree& tree,
+                                    const Name& name,
+                                    const attribute_compression::Settings& settings);
+
 ////////////////////////////////////////
 
 
@@ -320,9 +332,11 @@ struct BloscCompressAttributesOp {
     typedef std::vector<size_t>                                 Indices;
 
     BloscCompressAttributesOp(  PointDataTreeType& tree,
-                                const Indices& indices)
+                                const Indices& indices,
+                                const attribute_compression::Settings* settings = NULL)
         : mTree(tree)
-        , mIndices(indices) { }
+        , mIndices(indices)
+        , mSettings(settings) { }
 
     void operator()(const LeafRangeT& range) const {
 
@@ -332,6 +346,7 @@ struct BloscCompressAttributesOp {
                                             itEnd = mIndices.end(); it != itEnd; ++it) {
 
                 AttributeArray& array = leaf->attributeArray(*it);
+                if (mSettings)  array.setCompressionSettings(*mSettings);
                 array.compress();
             }
         }
@@ -339,8 +354,9 @@ struct BloscCompressAttributesOp {
 
     //////////
 
-    PointDataTreeType&              mTree;
-    const Indices&                  mIndices;
+    PointDataTreeType&                          mTree;
+    const Indices&                              mIndices;
+    const attribute_compression::Settings*      mSettings;
 }; // class BloscCompressAttributesOp
 
 
@@ -649,6 +665,41 @@ inline void bloscCompressAttribute( PointDataTree& tree,
     tbb::parallel_for(LeafManagerT(tree).leafRange(), BloscCompressAttributesOp<PointDataTree>(tree, indices));
 }
 
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void bloscCompressAttribute( PointDataTree& tree,
+                                    const Name& name,
+                                    const attribute_compression::Settings& settings)
+{
+    using point_attribute_internal::BloscCompressAttributesOp;
+
+    typedef typename tree::LeafManager<PointDataTree>       LeafManagerT;
+    typedef AttributeSet::Descriptor                        Descriptor;
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const Descriptor& descriptor = iter->attributeSet().descriptor();
+
+    // throw if index cannot be found in descriptor
+
+    const size_t index = descriptor.find(name);
+    if (index == AttributeSet::INVALID_POS) {
+        OPENVDB_THROW(KeyError, "Cannot find requested attribute - " << name << ".");
+    }
+
+    // store settings and blosc compress attributes
+
+    std::vector<size_t> indices;
+    indices.push_back(index);
+
+    tbb::parallel_for(LeafManagerT(tree).leafRange(), BloscCompressAttributesOp<PointDataTree>(tree, indices, &settings));
+}
+
 ////////////////////////////////////////
 
 
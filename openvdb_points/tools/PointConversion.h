@@ -46,6 +46,7 @@
 #include <openvdb_points/tools/AttributeArrayString.h>
 #include <openvdb_points/tools/AttributeSet.h>
 #include <openvdb_points/tools/IndexFilter.h>
+#include <openvdb_points/tools/PointAttribute.h>
 #include <openvdb_points/tools/PointDataGrid.h>
 #include <openvdb_points/tools/PointGroup.h>
 
@@ -96,6 +97,30 @@ createPointDataGrid(const std::vector<ValueT>& positions, const math::Transform&
                     Metadata::Ptr positionDefaultValue = Metadata::Ptr());
 
 
+/// @brief  Compress the positions of a @c PointDataGrid so that no position moves by more
+///         than a world space tolerance.
+///
+/// @param  grid        the PointDataGrid to be compressed.
+/// @param  tolerance   the maximum world space distance any position moves.
+/// @param  settings    compression settings (the tolerance of which is replaced).
+///
+/// @note   Positions created with the QuantizedPositionCodec are quantized in each leaf with
+///         only as many bits as that leaf requires, other position types are compressed
+///         with Blosc and the tolerance is ignored.
+///
+/// @note   Positions are stored in index space and quantized per axis, so the tolerance is
+///         divided by the sum of the dimensions of a voxel, which bounds the distance a
+///         position moves for any linear transform (including sheared transforms).
+///
+/// @throw  ValueError if the tolerance is not positive or the transform of the grid is not
+///         linear, as the world space error of a non-linear transform varies with position.
+
+template <typename PointDataGridT>
+inline void
+quantizePositions(  PointDataGridT& grid, const float tolerance,
+                    const attribute_compression::Settings& settings = attribute_compression::Settings());
+
+
 /// @brief  Stores point attribute data in an existing @c PointDataGrid attribute.
 ///
 /// @param  tree            the PointDataGrid to be populated.
@@ -481,30 +506,63 @@ struct ConvertPointDataGridPositionOp {
 
             if (leaf.pos() > 0)     offset += mPointOffsets[leaf.pos() - 1];
 
-            typename AttributeHandle<ValueType>::Ptr handle =
-                    AttributeHandle<ValueType>::create(leaf->constAttributeArray(mIndex));
+            const AttributeArray& array = leaf->constAttributeArray(mIndex);
 
-            if (useGroups) {
-                IndexIterT iter = leaf->beginIndexOn(MultiGroupFilter(mIncludeGroups, mExcludeGroups));
+            // resolve the position codec once per leaf so that decoding is inlined
 
-                for (; iter; ++iter) {
-                    const Vec3d xyz = iter.getCoord().asVec3d();
-                    const Vec3d pos = handle->get(Index64(*iter));
-                    pHandle.set(offset++, /*stride=*/ 0, mTransform.indexToWorld(pos + xyz));
-                }
+            ConvertLeafOp convertLeaf(*this, *leaf, pHandle, offset, useGroups);
+
+            if (!dispatchTypedAttributeArray<ValueType>(array, convertLeaf)) {
+                AttributeHandle<ValueType> handle(array);
+                this->convert(*leaf, handle, pHandle, offset, useGroups);
             }
-            else {
-                typename LeafNode::IndexOnIter iter = leaf->beginIndexOn();
+        }
+    }
 
-                for (; iter; ++iter) {
-                    const Vec3d xyz = iter.getCoord().asVec3d();
-                    const Vec3d pos = handle->get(Index64(*iter));
-                    pHandle.set(offset++, /*stride=*/ 0, mTransform.indexToWorld(pos + xyz));
-                }
+    template <typename HandleT>
+    void convert(   const LeafNode& leaf, const HandleT& handle,
+                    typename Attribute::Handle& pHandle, Index64& offset, const bool useGroups) const
+    {
+        if (useGroups) {
+            IndexIterT iter = leaf.beginIndexOn(MultiGroupFilter(mIncludeGroups, mExcludeGroups));
+
+            for (; iter; ++iter) {
+                const Vec3d xyz = iter.getCoord().asVec3d();
+                const Vec3d pos = handle.get(Index64(*iter));
+                pHandle.set(offset++, /*stride=*/ 0, mTransform.indexToWorld(pos + xyz));
+            }
+        }
+        else {
+            typename LeafNode::IndexOnIter iter = leaf.beginIndexOn();
+
+            for (; iter; ++iter) {
+                const Vec3d xyz = iter.getCoord().asVec3d();
+                const Vec3d pos = handle.get(Index64(*iter));
+                pHandle.set(offset++, /*stride=*/ 0, mTransform.indexToWorld(pos + xyz));
             }
         }
     }
 
+    struct ConvertLeafOp
+    {
+        ConvertLeafOp(  const ConvertPointDataGridPositionOp& op, const LeafNode& leaf,
+                        typename Attribute::Handle& pHandle, Index64& offset, const bool useGroups)
+            : mOp(op), mLeaf(leaf), mHandle(pHandle), mOffset(offset), mUseGroups(useGroups) { }
+
+        template <typename TypedAttributeArrayT>
+        void operator()(const TypedAttributeArrayT& array) const
+        {
+            AttributeHandle<ValueType, typename TypedAttributeArrayT::Codec> handle(array);
+            mOp.convert(mLeaf, handle, mHandle, mOffset, mUseGroups);
+        }
+
+        const ConvertPointDataGridPositionOp&   mOp;
+        const LeafNode&                         mLeaf;
+        typename Attribute::Handle&             mHandle;
+        Index64&                                mOffset;
+        const bool                              mUseGroups;
+    }; // struct ConvertLeafOp
+
     //////////
 
     Attribute&                              mAttribute;
@@ -808,6 +866,36 @@ createPointDataGrid(const std::vector<ValueT>& positions,
 ////////////////////////////////////////
 
 
+template <typename PointDataGridT>
+inline void
+quantizePositions(  PointDataGridT& grid, const float tolerance,
+                    const attribute_compression::Settings& settings)
+{
+    if (!(tolerance > 0.0f)) {
+        OPENVDB_THROW(ValueError, "Position tolerance must be positive - " << tolerance << ".");
+    }
+
+    if (!grid.transform().isLinear()) {
+        OPENVDB_THROW(ValueError, "Positions can only be quantized with a linear transform.");
+    }
+
+    // convert the tolerance to index space, each axis is quantized separately and moves
+    // a position by at most the per-axis tolerance times the length of that voxel axis,
+    // so the sum of the voxel dimensions bounds the distance even if the axes are sheared
+
+    const Vec3d voxelSize = grid.transform().voxelSize();
+    const double sumVoxelSize = voxelSize[0] + voxelSize[1] + voxelSize[2];
+
+    attribute_compression::Settings positionSettings(settings);
+    positionSettings.tolerance = float(tolerance / sumVoxelSize);
+
+    bloscCompressAttribute(grid.tree(), "P", positionSettings);
+}
+
+
+////////////////////////////////////////
+
+
 template <typename PointDataTreeT, typename PointIndexTreeT, typename PointArrayT, bool Strided>
 inline void
 populateAttribute(  PointDataTreeT& tree, const PointIndexTreeT& pointIndexTree,
@@ -120,6 +120,58 @@ Index64 inactiveGroupPointCount(const PointDataTreeT& tree, const Name& name, co
 
 namespace point_count_internal {
 
+enum LeafCountMode { COUNT_ALL = 0, COUNT_ACTIVE, COUNT_INACTIVE };
+
+
+/// Sum the point counts of each leaf, which are computed from the leaf voxel offsets
+template <typename PointDataTreeT>
+struct LeafPointCountOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeT>    LeafManagerT;
+
+    LeafPointCountOp(const LeafCountMode mode,
+                     const bool inCoreOnly = false)
+        : mMode(mode)
+        , mInCoreOnly(inCoreOnly) { }
+
+    Index64 operator()(const typename LeafManagerT::LeafRange& range, Index64 size) const {
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf = range.begin(); leaf; ++leaf) {
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+            if (mInCoreOnly && leaf->buffer().isOutOfCore())     continue;
+#endif
+
+            if (mMode == COUNT_ACTIVE)          size += leaf->onPointCount();
+            else if (mMode == COUNT_INACTIVE)   size += leaf->offPointCount();
+            else                                size += leaf->pointCount();
+        }
+
+        return size;
+    }
+
+    static Index64 join(Index64 size1, Index64 size2) {
+        return size1 + size2;
+    }
+
+private:
+    const LeafCountMode mMode;
+    const bool mInCoreOnly;
+}; // struct LeafPointCountOp
+
+
+template <typename PointDataTreeT>
+Index64 threadedLeafPointCount( const PointDataTreeT& tree,
+                                const LeafCountMode mode,
+                                const bool inCoreOnly = false)
+{
+    typedef point_count_internal::LeafPointCountOp<PointDataTreeT> LeafPointCountOp;
+
+    typename tree::LeafManager<const PointDataTreeT> leafManager(tree);
+    const LeafPointCountOp leafPointCountOp(mode, inCoreOnly);
+    return tbb::parallel_reduce(leafManager.leafRange(), Index64(0), leafPointCountOp, LeafPointCountOp::join);
+}
+
+
 template <  typename PointDataTreeT,
             typename ValueIterT,
             typename FilterT>
@@ -156,6 +208,65 @@ private:
 }; // struct PointCountOp
 
 
+/// Count the points in a group, leaves with no members or all members are not iterated
+template <  typename PointDataTreeT,
+            typename ValueIterT>
+struct GroupPointCountOp
+{
+    typedef typename tree::LeafManager<const PointDataTreeT>    LeafManagerT;
+
+    GroupPointCountOp(const Name& name,
+                      const bool inCoreOnly = false)
+        : mName(name)
+        , mInCoreOnly(inCoreOnly) { }
+
+    Index64 operator()(const typename LeafManagerT::LeafRange& range, Index64 size) const {
+
+        for (typename LeafManagerT::LeafRange::Iterator leaf = range.begin(); leaf; ++leaf) {
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+            if (mInCoreOnly && leaf->buffer().isOutOfCore())     continue;
+#endif
+
+            const GroupHandle::Membership membership = leaf->groupHandle(mName).membership();
+
+            if (membership == GroupHandle::NO_MEMBERS)  continue;
+
+            if (membership == GroupHandle::ALL_MEMBERS) {
+                NullFilter filter;
+                size += iterCount(leaf->template beginIndex<ValueIterT, NullFilter>(filter));
+                continue;
+            }
+
+            GroupFilter filter(mName);
+            size += iterCount(leaf->template beginIndex<ValueIterT, GroupFilter>(filter));
+        }
+
+        return size;
+    }
+
+    static Index64 join(Index64 size1, Index64 size2) {
+        return size1 + size2;
+    }
+
+private:
+    const Name& mName;
+    const bool mInCoreOnly;
+}; // struct GroupPointCountOp
+
+
+template <typename PointDataTreeT, typename ValueIterT>
+Index64 threadedGroupPointCount(const PointDataTreeT& tree,
+                                const Name& name,
+                                const bool inCoreOnly = false)
+{
+    typedef point_count_internal::GroupPointCountOp<PointDataTreeT, ValueIterT> GroupPointCountOp;
+
+    typename tree::LeafManager<const PointDataTreeT> leafManager(tree);
+    const GroupPointCountOp groupPointCountOp(name, inCoreOnly);
+    return tbb::parallel_reduce(leafManager.leafRange(), Index64(0), groupPointCountOp, GroupPointCountOp::join);
+}
+
+
 template <typename PointDataTreeT, typename FilterT, typename ValueIterT>
 Index64 threadedFilterPointCount(   const PointDataTreeT& tree,
                                     const FilterT& filter,
@@ -205,75 +316,45 @@ Index64 filterInactivePointCount(   const PointDataTreeT& tree,
 template <typename PointDataTreeT>
 Index64 pointCount(const PointDataTreeT& tree, const bool inCoreOnly)
 {
-    (void) inCoreOnly;
-    Index64 size = 0;
-    for (typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
-#ifndef OPENVDB_2_ABI_COMPATIBLE
-        if (inCoreOnly && iter->buffer().isOutOfCore())     continue;
-#else
-        (void) inCoreOnly; // unused variable
-#endif
-        size += iter->pointCount();
-    }
-    return size;
+    return point_count_internal::threadedLeafPointCount(tree, point_count_internal::COUNT_ALL, inCoreOnly);
 }
 
 
 template <typename PointDataTreeT>
 Index64 activePointCount(const PointDataTreeT& tree, const bool inCoreOnly)
 {
-    (void) inCoreOnly;
-    Index64 size = 0;
-    for (typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
-#ifndef OPENVDB_2_ABI_COMPATIBLE
-        if (inCoreOnly && iter->buffer().isOutOfCore())     continue;
-#else
-        (void) inCoreOnly; // unused variable
-#endif
-        size += iter->onPointCount();
-    }
-    return size;
+    return point_count_internal::threadedLeafPointCount(tree, point_count_internal::COUNT_ACTIVE, inCoreOnly);
 }
 
 
 template <typename PointDataTreeT>
 Index64 inactivePointCount(const PointDataTreeT& tree, const bool inCoreOnly)
 {
-    (void) inCoreOnly;
-    Index64 size = 0;
-    for (typename PointDataTreeT::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
-#ifndef OPENVDB_2_ABI_COMPATIBLE
-        if (inCoreOnly && iter->buffer().isOutOfCore())     continue;
-#else
-        (void) inCoreOnly; // unused variable
-#endif
-        size += iter->offPointCount();
-    }
-    return size;
+    return point_count_internal::threadedLeafPointCount(tree, point_count_internal::COUNT_INACTIVE, inCoreOnly);
 }
 
 
 template <typename PointDataTreeT>
 Index64 groupPointCount(const PointDataTreeT& tree, const Name& name, const bool inCoreOnly)
 {
-    GroupFilter groupFilter(name);
-    return point_count_internal::filterPointCount<PointDataTreeT, GroupFilter>(tree, groupFilter, inCoreOnly);
+    typedef typename PointDataTreeT::LeafNodeType::ValueAllCIter ValueIterT;
+    return point_count_internal::threadedGroupPointCount<PointDataTreeT, ValueIterT>(tree, name, inCoreOnly);
 }
 
 
 template <typename PointDataTreeT>
 Index64 activeGroupPointCount(const PointDataTreeT& tree, const Name& name, const bool inCoreOnly)
 {
-    GroupFilter groupFilter(name);
-    return point_count_internal::filterActivePointCount<PointDataTreeT, GroupFilter>(tree, groupFilter, inCoreOnly);
+    typedef typename PointDataTreeT::LeafNodeType::ValueOnCIter ValueIterT;
+    return point_count_internal::threadedGroupPointCount<PointDataTreeT, ValueIterT>(tree, name, inCoreOnly);
 }
 
 
 template <typename PointDataTreeT>
 Index64 inactiveGroupPointCount(const PointDataTreeT& tree, const Name& name, const bool inCoreOnly)
 {
-    GroupFilter groupFilter(name);
-    return point_count_internal::filterInactivePointCount<PointDataTreeT, GroupFilter>(tree, groupFilter, inCoreOnly);
+    typedef typename PointDataTreeT::LeafNodeType::ValueOffCIter ValueIterT;
+    return point_count_internal::threadedGroupPointCount<PointDataTreeT, ValueIterT>(tree, name, inCoreOnly);
 }
 
 
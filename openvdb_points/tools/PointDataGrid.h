@@ -272,11 +272,13 @@ public:
     /// @brief Read-write group handle from group name
     GroupWriteHandle groupWriteHandle(const Name& name);
 
-    /// @brief Compute the total point count for the leaf
+    /// @brief Return the total point count for the leaf, read from the last voxel offset
     Index64 pointCount() const;
-    /// @brief Compute the total active (on) point count for the leaf
+    /// @brief Compute the total active (on) point count for the leaf from the offsets
+    /// of the active voxels
     Index64 onPointCount() const;
-    /// @brief Compute the total inactive (off) point count for the leaf
+    /// @brief Compute the total inactive (off) point count for the leaf as the total
+    /// point count minus the active point count
     Index64 offPointCount() const;
     /// @brief Compute the point count in a specific group for the leaf
     Index64 groupPointCount(const Name& groupName) const;
@@ -399,7 +401,9 @@ public:
     template<typename ModifyOp>
     void modifyValueAndActiveState(const Coord&, const ModifyOp&) { assertNonmodifiable(); }
 
-    void clip(const CoordBBox&, const ValueType&) { assertNonmodifiable(); }
+    /// @brief Remove the points in voxels outside the bounding box and deactivate those
+    /// voxels, the background value is ignored as voxel values are point offsets
+    void clip(const CoordBBox&, const ValueType& background);
 
     void fill(const CoordBBox&, const ValueType&, bool) { assertNonmodifiable(); }
     void fill(const ValueType&) {}
@@ -911,7 +915,9 @@ template<typename T, Index Log2Dim>
 inline Index64
 PointDataLeafNode<T, Log2Dim>::pointCount() const
 {
-    return iterCount(this->beginIndexAll());
+    // the voxel values are cumulative offsets, so the last one is the total
+
+    return Index64(this->getValue(LeafNodeType::NUM_VALUES - 1));
 }
 
 template<typename T, Index Log2Dim>
@@ -920,7 +926,14 @@ PointDataLeafNode<T, Log2Dim>::onPointCount() const
 {
     if (this->isEmpty())        return 0;
     else if (this->isDense())   return this->pointCount();
-    return iterCount(this->beginIndexOn());
+
+    Index64 count = 0;
+    for (ValueOnCIter iter = this->cbeginValueOn(); iter; ++iter) {
+        const Index offset = iter.pos();
+        const ValueType start = offset > 0 ? this->getValue(offset - 1) : ValueType(0);
+        count += Index64(*iter - start);
+    }
+    return count;
 }
 
 template<typename T, Index Log2Dim>
@@ -929,13 +942,18 @@ PointDataLeafNode<T, Log2Dim>::offPointCount() const
 {
     if (this->isEmpty())        return this->pointCount();
     else if (this->isDense())   return 0;
-    return iterCount(this->beginIndexOff());
+    return this->pointCount() - this->onPointCount();
 }
 
 template<typename T, Index Log2Dim>
 inline Index64
 PointDataLeafNode<T, Log2Dim>::groupPointCount(const Name& groupName) const
 {
+    const GroupHandle::Membership membership = this->groupHandle(groupName).membership();
+
+    if (membership == GroupHandle::NO_MEMBERS)          return 0;
+    else if (membership == GroupHandle::ALL_MEMBERS)    return this->pointCount();
+
     GroupFilter filter(groupName);
     return iterCount(this->beginIndexAll(filter));
 }
@@ -972,6 +990,11 @@ inline void
 PointDataLeafNode<T, Log2Dim>::readTopology(std::istream& is, bool fromHalf)
 {
     BaseLeaf::readTopology(is, fromHalf);
+
+    // topology for all leaf nodes is read before any buffers, so this ensures the
+    // first leaf node in each grid reads a full attribute descriptor
+
+    AttributeSet::resetDescriptorStream(is);
 }
 
 template<typename T, Index Log2Dim>
@@ -979,6 +1002,11 @@ inline void
 PointDataLeafNode<T, Log2Dim>::writeTopology(std::ostream& os, bool toHalf) const
 {
     BaseLeaf::writeTopology(os, toHalf);
+
+    // topology for all leaf nodes is written before any buffers, so this ensures the
+    // first leaf node in each grid writes a full attribute descriptor
+
+    AttributeSet::resetDescriptorStream(os);
 }
 
 template<typename T, Index Log2Dim>
@@ -994,10 +1022,97 @@ template<typename T, Index Log2Dim>
 inline void
 PointDataLeafNode<T, Log2Dim>::readBuffers(std::istream& is, const CoordBBox& bbox, bool fromHalf)
 {
-    // Read and clip voxel values (no clipping yet).
-    BaseLeaf::readBuffers(is, bbox, fromHalf);
+    // read all voxel offsets and attributes, as the offsets of every voxel are needed to
+    // locate the points of the voxels that are inside the bounding box
+
+    BaseLeaf::readBuffers(is, fromHalf);
 
     mAttributeSet->read(is);
+
+    this->clip(bbox, zeroVal<ValueType>());
+}
+
+template<typename T, Index Log2Dim>
+inline void
+PointDataLeafNode<T, Log2Dim>::clip(const CoordBBox& bbox, const ValueType& /*background*/)
+{
+    // leaf nodes entirely inside the bounding box are not clipped (nor loaded if delay-loading)
+
+    const CoordBBox nodeBBox = this->getNodeBoundingBox();
+
+    if (bbox.isInside(nodeBBox))    return;
+
+    if (!bbox.hasOverlap(nodeBBox)) {
+        this->clearAttributes();
+        return;
+    }
+
+    // rewrite the voxel offsets to only include the points of voxels inside the bounding box
+    // and deactivate the voxels outside, recording the indices of the points to retain
+
+    std::vector<Index> indices;
+    Index start = 0;
+
+    for (Index n = 0; n < BaseLeaf::SIZE; n++) {
+        const Index end = Index(this->getValue(n));
+        if (bbox.isInside(this->offsetToGlobalCoord(n))) {
+            for (Index index = start; index < end; index++)     indices.push_back(index);
+        }
+        else {
+            this->setValueOff(n);
+        }
+        this->setOffsetOnly(n, ValueType(Index(indices.size())));
+        start = end;
+    }
+
+    if (indices.size() == start)    return;
+
+    // compact the attribute arrays to only the retained points
+
+    AttributeSet* attributeSet = new AttributeSet(*mAttributeSet);
+
+    const size_t size = indices.size();
+
+    for (size_t pos = 0; pos < attributeSet->size(); pos++) {
+        const AttributeArray& source = *attributeSet->getConst(pos);
+        const Index stride = source.stride();
+        const bool uniform = source.isUniform();
+        const bool compressed = source.isCompressed();
+
+        // quantized positions are left uncompressed, as quantizing them again relative to
+        // the bounds of the retained points would exceed the tolerance they were written with
+
+        const bool quantized = source.type().second == QuantizedPositionCodec::name();
+
+        AttributeArray::Ptr target = AttributeArray::create(source.type(), size, stride);
+
+        if (source.isHidden())      target->setHidden(true);
+        if (source.isTransient())   target->setTransient(true);
+        if (source.isInterleaved()) target->setInterleaved(true);
+        target->setCompressionSettings(source.compressionSettings());
+
+        if (source.isInterleaved()) {
+            for (Index m = 0; m < stride; m++) {
+                for (size_t n = 0; n < size; n++) {
+                    target->set(Index(m * size + n), source, Index(m * source.size() + indices[n]));
+                }
+            }
+        }
+        else {
+            for (size_t n = 0; n < size; n++) {
+                for (Index m = 0; m < stride; m++) {
+                    target->set(Index(n * stride + m), source, indices[n] * stride + m);
+                }
+            }
+        }
+
+        if (uniform)        target->compact();
+        if (compressed && !quantized)   target->compress();
+
+        attributeSet->replace(pos, target);
+    }
+
+    mAttributeSet.reset(attributeSet);
 }
 
 template<typename T, Index Log2Dim>
@@ -144,6 +144,48 @@ inline void setGroupByFilter(   PointDataTree& tree,
                                 const Name& group,
                                 const FilterT& filter);
 
+/// @brief Sets group membership to the union of the membership of other groups.
+///
+/// @param tree          the PointDataTree.
+/// @param group         the name of the group.
+/// @param sources       the names of the groups to combine (may include @a group).
+template <typename PointDataTree>
+inline void setGroupByUnion(    PointDataTree& tree,
+                                const Name& group,
+                                const std::vector<Name>& sources);
+
+/// @brief Sets group membership to the intersection of the membership of other groups.
+///
+/// @param tree          the PointDataTree.
+/// @param group         the name of the group.
+/// @param sources       the names of the groups to combine (may include @a group).
+template <typename PointDataTree>
+inline void setGroupByIntersection( PointDataTree& tree,
+                                    const Name& group,
+                                    const std::vector<Name>& sources);
+
+/// @brief Sets group membership to the points of one group that are in none of the others.
+///
+/// @param tree          the PointDataTree.
+/// @param group         the name of the group.
+/// @param source        the name of the group to subtract from.
+/// @param subtract      the names of the groups to subtract.
+template <typename PointDataTree>
+inline void setGroupByDifference(   PointDataTree& tree,
+                                    const Name& group,
+                                    const Name& source,
+                                    const std::vector<Name>& subtract);
+
+/// @brief Sets group membership to the points that are not in another group.
+///
+/// @param tree          the PointDataTree.
+/// @param group         the name of the group.
+/// @param source        the name of the group to complement (may be @a group).
+template <typename PointDataTree>
+inline void setGroupByComplement(   PointDataTree& tree,
+                                    const Name& group,
+                                    const Name& source);
+
 
 ////////////////////////////////////////
 
@@ -151,41 +193,154 @@ inline void setGroupByFilter(   PointDataTree& tree,
 namespace point_group_internal {
 
 
-/// Copy a group attribute value from one group offset to another
+/// Move groups between group offsets with a single pass over the leaves, the moves
+/// between each pair of group attribute arrays are applied as a byte lookup table
 template<typename PointDataTreeType>
-struct CopyGroupOp {
+struct MoveGroupsOp {
 
     typedef typename tree::LeafManager<PointDataTreeType>       LeafManagerT;
     typedef typename LeafManagerT::LeafRange                    LeafRangeT;
     typedef AttributeSet::Descriptor::GroupIndex                GroupIndex;
+    typedef std::pair<GroupIndex, GroupIndex>                   GroupMove;
 
-    CopyGroupOp(PointDataTreeType& tree,
-                const GroupIndex& targetIndex,
-                const GroupIndex& sourceIndex)
-        : mTree(tree)
-        , mTargetIndex(targetIndex)
-        , mSourceIndex(sourceIndex) { }
+    /// Bit permutation from one group attribute array to another
+    struct BytePermutation
+    {
+        size_t      sourcePos;
+        size_t      targetPos;
+        GroupType   targetMask;
+        GroupType   table[256];
+    };
+
+    /// @param moves    pairs of source and target group indices, no target may be a source
+    MoveGroupsOp(const std::vector<GroupMove>& moves)
+    {
+        for (typename std::vector<GroupMove>::const_iterator    it = moves.begin(),
+                                                                itEnd = moves.end(); it != itEnd; ++it) {
 
-    void operator()(const typename LeafManagerT::LeafRange& range) const {
+            const GroupIndex& source = it->first;
+            const GroupIndex& target = it->second;
 
-        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+            BytePermutation* permutation = NULL;
 
-            GroupHandle sourceGroup = leaf->groupHandle(mSourceIndex);
-            GroupWriteHandle targetGroup = leaf->groupWriteHandle(mTargetIndex);
+            for (size_t i = 0; i < mPermutations.size(); i++) {
+                if (mPermutations[i].sourcePos == source.first &&
+                    mPermutations[i].targetPos == target.first) {
+                    permutation = &mPermutations[i];
+                    break;
+                }
+            }
 
-            for (typename PointDataTreeType::LeafNodeType::IndexAllIter iter = leaf->beginIndexAll(); iter; ++iter) {
-                const bool groupOn = sourceGroup.get(*iter);
-                targetGroup.set(*iter, groupOn);
+            if (!permutation) {
+                BytePermutation newPermutation;
+                newPermutation.sourcePos = source.first;
+                newPermutation.targetPos = target.first;
+                newPermutation.targetMask = 0;
+                std::fill(newPermutation.table, newPermutation.table + 256, GroupType(0));
+                mPermutations.push_back(newPermutation);
+                permutation = &mPermutations.back();
+
+                if (std::find(mTargets.begin(), mTargets.end(), target.first) == mTargets.end()) {
+                    mTargets.push_back(target.first);
+                }
+            }
+
+            const GroupType sourceBit = GroupType(1) << source.second;
+            const GroupType targetBit = GroupType(1) << target.second;
+
+            permutation->targetMask |= targetBit;
+
+            for (Index value = 0; value < 256; value++) {
+                if (value & sourceBit)  permutation->table[value] |= targetBit;
+            }
+        }
+    }
+
+    void operator()(const LeafRangeT& range) const {
+
+        for (typename LeafRangeT::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            for (typename std::vector<BytePermutation>::const_iterator  it = mPermutations.begin(),
+                                                                        itEnd = mPermutations.end(); it != itEnd; ++it) {
+
+                GroupAttributeArray& source =
+                    GroupAttributeArray::cast(leaf->attributeArray(it->sourcePos));
+                GroupAttributeArray& target =
+                    GroupAttributeArray::cast(leaf->attributeArray(it->targetPos));
+
+                source.loadData();
+                if (source.isCompressed())      source.decompress();
+
+                target.loadWritableData();
+                if (target.isCompressed())      target.decompress();
+
+                const GroupType keepMask = GroupType(~it->targetMask);
+
+                // uniform source and target arrays remain uniform
+
+                if (source.isUniform() && target.isUniform()) {
+                    target.collapse(GroupType(target.getUnsafe(0) & keepMask) |
+                        it->table[source.getUnsafe(0)]);
+                    continue;
+                }
+
+                // target bits are never source bits, so the arrays may be the same
+
+                target.expand();
+
+                for (Index n = 0, size = Index(target.size()); n < size; n++) {
+                    target.setUnsafe(n, GroupType(target.getUnsafe(n) & keepMask) |
+                        it->table[source.getUnsafe(n)]);
+                }
+            }
+
+            // attempt to compact the modified arrays
+
+            for (std::vector<size_t>::const_iterator    it = mTargets.begin(),
+                                                        itEnd = mTargets.end(); it != itEnd; ++it) {
+                leaf->attributeArray(*it).compact();
             }
         }
     }
 
     //////////
 
-    PointDataTreeType&      mTree;
-    const GroupIndex        mTargetIndex;
-    const GroupIndex        mSourceIndex;
-};
+    std::vector<BytePermutation>    mPermutations;
+    std::vector<size_t>             mTargets;
+}; // struct MoveGroupsOp
+
+
+/// Append new group attribute arrays at the given positions in a single pass
+template<typename PointDataTreeType>
+struct AppendGroupAttributesOp {
+
+    typedef typename tree::LeafManager<PointDataTreeType>       LeafManagerT;
+    typedef typename LeafManagerT::LeafRange                    LeafRangeT;
+
+    AppendGroupAttributesOp(AttributeSet::DescriptorPtr& descriptor,
+                            const std::vector<size_t>& positions)
+        : mDescriptor(descriptor)
+        , mPositions(positions) { }
+
+    void operator()(const LeafRangeT& range) const {
+
+        for (typename LeafRangeT::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            // the first append replaces the descriptor, which is then the expected one
+
+            for (std::vector<size_t>::const_iterator    it = mPositions.begin(),
+                                                        itEnd = mPositions.end(); it != itEnd; ++it) {
+                const AttributeSet::Descriptor& expected = leaf->attributeSet().descriptor();
+                leaf->appendAttribute(expected, mDescriptor, *it);
+            }
+        }
+    }
+
+    //////////
+
+    AttributeSet::DescriptorPtr&    mDescriptor;
+    const std::vector<size_t>&      mPositions;
+}; // struct AppendGroupAttributesOp
 
 
 /// Set membership on or off for the specified group
@@ -317,6 +472,138 @@ struct SetGroupByFilterOp
 }; // struct SetGroupByFilterOp
 
 
+enum GroupOperation {
+    GROUP_UNION = 0,
+    GROUP_INTERSECTION,
+    GROUP_DIFFERENCE,
+    GROUP_COMPLEMENT
+};
+
+
+/// Set membership of a group by combining the membership of other groups 64 points at a time
+template <typename PointDataTree>
+struct SetGroupByOperationOp
+{
+    typedef typename tree::LeafManager<PointDataTree>   LeafManagerT;
+    typedef AttributeSet::Descriptor::GroupIndex        GroupIndex;
+    typedef std::vector<GroupIndex>                     GroupIndices;
+    typedef std::vector<GroupHandle>                    HandleVector;
+
+    SetGroupByOperationOp(  const GroupIndex& index,
+                            const GroupIndices& sourceIndices,
+                            const GroupOperation operation)
+        : mIndex(index)
+        , mSourceIndices(sourceIndices)
+        , mOperation(operation) { }
+
+    /// Return the membership bits of @a word combined across all source groups
+    Index64 combine(const HandleVector& handles, const Index word) const
+    {
+        Index64 bits = handles.front().getWord(word);
+
+        for (typename HandleVector::const_iterator  it = handles.begin() + 1,
+                                                    itEnd = handles.end(); it != itEnd; ++it) {
+            if (mOperation == GROUP_UNION)              bits |= it->getWord(word);
+            else if (mOperation == GROUP_INTERSECTION)  bits &= it->getWord(word);
+            else if (mOperation == GROUP_DIFFERENCE)    bits &= ~it->getWord(word);
+        }
+
+        if (mOperation == GROUP_COMPLEMENT)             bits = ~bits;
+
+        return bits;
+    }
+
+    void operator()(const typename LeafManagerT::LeafRange& range) const
+    {
+        for (typename LeafManagerT::LeafRange::Iterator leaf=range.begin(); leaf; ++leaf) {
+
+            // source handles are created first as the target may share an array with them
+
+            HandleVector handles;
+            handles.reserve(mSourceIndices.size());
+
+            bool uniform = true;
+
+            for (typename GroupIndices::const_iterator  it = mSourceIndices.begin(),
+                                                        itEnd = mSourceIndices.end(); it != itEnd; ++it) {
+                handles.push_back(leaf->groupHandle(*it));
+                uniform &= handles.back().isUniform();
+            }
+
+            GroupWriteHandle group(leaf->groupWriteHandle(mIndex));
+
+            if (group.size() == 0)  continue;
+
+            // uniform sources produce uniform membership, which is collapsed
+
+            if (uniform) {
+                group.collapse((this->combine(handles, 0) & Index64(1)) != 0);
+                continue;
+            }
+
+            for (Index word = 0, words = group.wordCount(); word < words; word++) {
+                group.setWord(word, this->combine(handles, word));
+            }
+
+            // attempt to compact the array
+
+            group.compact();
+        }
+    }
+
+    //////////
+
+    const GroupIndex mIndex;
+    const GroupIndices mSourceIndices;
+    const GroupOperation mOperation;
+}; // struct SetGroupByOperationOp
+
+
+/// Set membership of @a group from an operation applied to the groups in @a sources
+template <typename PointDataTree>
+inline void setGroupByOperation(PointDataTree& tree,
+                                const Name& group,
+                                const std::vector<Name>& sources,
+                                const GroupOperation operation)
+{
+    typedef AttributeSet::Descriptor Descriptor;
+    typedef typename tree::template LeafManager<PointDataTree> LeafManagerT;
+
+    if (sources.empty()) {
+        OPENVDB_THROW(ValueError, "At least one source group is required.");
+    }
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const AttributeSet& attributeSet = iter->attributeSet();
+    const Descriptor& descriptor = attributeSet.descriptor();
+
+    if (!descriptor.hasGroup(group)) {
+        OPENVDB_THROW(LookupError, "Group must exist on Tree before defining membership.");
+    }
+
+    std::vector<Descriptor::GroupIndex> sourceIndices;
+    sourceIndices.reserve(sources.size());
+
+    for (std::vector<Name>::const_iterator  it = sources.begin(),
+                                            itEnd = sources.end(); it != itEnd; ++it) {
+        if (!descriptor.hasGroup(*it)) {
+            OPENVDB_THROW(LookupError, "Source group must exist on Tree.");
+        }
+        sourceIndices.push_back(attributeSet.groupIndex(*it));
+    }
+
+    const Descriptor::GroupIndex index = attributeSet.groupIndex(group);
+
+    // set membership by combining the source groups
+
+    SetGroupByOperationOp<PointDataTree> set(index, sourceIndices, operation);
+    tbb::parallel_for(LeafManagerT(tree).leafRange(), set);
+}
+
+
 ////////////////////////////////////////
 
 
@@ -326,6 +613,14 @@ class GroupInfo
 public:
     typedef AttributeSet::Descriptor Descriptor;
 
+    /// Move of a group from one group slot to another
+    struct GroupMove
+    {
+        Name    name;
+        size_t  sourceOffset;
+        size_t  targetOffset;
+    };
+
     GroupInfo(const AttributeSet& attributeSet)
         : mAttributeSet(attributeSet) { }
 
@@ -362,31 +657,24 @@ public:
         return this->unusedGroups() >= this->groupBits();
     }
 
-    /// Return the next empty group slot
-    size_t nextUnusedOffset() const
+    /// Fill the @p offsets vector with the first @a count empty group slots in ascending order
+    void populateUnusedOffsets(std::vector<size_t>& offsets, const size_t count) const
     {
-        const Descriptor::NameToPosMap& groupMap = mAttributeSet.descriptor().groupMap();
+        const Descriptor& descriptor = mAttributeSet.descriptor();
+        const Descriptor::NameToPosMap& groupMap = descriptor.groupMap();
 
-        // build a list of group indices
+        const size_t totalSlots =
+            descriptor.count(GroupAttributeArray::attributeType()) * this->groupBits();
 
-        std::vector<size_t> indices;
+        std::vector<bool> used(totalSlots, false);
         for (Descriptor::ConstIterator  it = groupMap.begin(),
                                         endIt = groupMap.end(); it != endIt; ++it) {
-            indices.push_back(it->second);
+            if (it->second < totalSlots)    used[it->second] = true;
         }
 
-        std::sort(indices.begin(), indices.end());
-
-        // return first index not present
-
-        size_t offset = 0;
-        for (std::vector<size_t>::const_iterator    it = indices.begin(),
-                                                    endIt = indices.end(); it != endIt; ++it) {
-            if (*it != offset)     break;
-            offset++;
+        for (size_t offset = 0; offset < totalSlots && offsets.size() < count; offset++) {
+            if (!used[offset])  offsets.push_back(offset);
         }
-
-        return offset;
     }
 
     /// Fill the @p indices vector with the indices correlating to the group attribute arrays
@@ -404,29 +692,34 @@ public:
         }
     }
 
-    /// Determine if a move is required to efficiently compact the data and store the
-    /// source name, offset and the target offset in the input parameters
-    bool requiresMove(Name& sourceName, size_t& sourceOffset, size_t& targetOffset) const {
+    /// Fill the @p moves vector with the group names and the source and target offsets
+    /// that move every group into the lowest group slots
+    void populateMoves(std::vector<GroupMove>& moves) const
+    {
+        const Descriptor::NameToPosMap& groupMap = mAttributeSet.descriptor().groupMap();
 
-        targetOffset = this->nextUnusedOffset();
+        // groups at offsets beyond the number of groups fill the empty slots below it
 
-        const Descriptor::NameToPosMap& groupMap = mAttributeSet.descriptor().groupMap();
+        const size_t groups = groupMap.size();
 
-        typedef Descriptor::NameToPosMap::const_reverse_iterator ReverseMapIterator;
+        std::vector<size_t> offsets;
+        this->populateUnusedOffsets(offsets, groups);
 
-        for (ReverseMapIterator it = groupMap.rbegin(),
-                                itEnd = groupMap.rend(); it != itEnd; ++it) {
+        std::vector<size_t>::const_iterator offsetIt = offsets.begin();
 
-            // move only required if source comes after the target
+        for (Descriptor::ConstIterator  it = groupMap.begin(),
+                                        itEnd = groupMap.end(); it != itEnd; ++it) {
 
-            if (it->second >= targetOffset) {
-                sourceName = it->first;
-                sourceOffset = it->second;
-                return true;
-            }
-        }
+            if (it->second < groups)    continue;
+
+            assert(offsetIt != offsets.end() && *offsetIt < groups);
 
-        return false;
+            GroupMove move;
+            move.name = it->first;
+            move.sourceOffset = it->second;
+            move.targetOffset = *offsetIt++;
+            moves.push_back(move);
+        }
     }
 
 private:
@@ -456,14 +749,28 @@ inline void deleteMissingPointGroups(   std::vector<std::string>& groups,
 
 template <typename PointDataTree>
 inline void appendGroup(PointDataTree& tree, const Name& group)
+{
+    appendGroups(tree, std::vector<Name>(1, group));
+}
+
+
+////////////////////////////////////////
+
+
+template <typename PointDataTree>
+inline void appendGroups(PointDataTree& tree,
+                         const std::vector<Name>& groups)
 {
     typedef AttributeSet::Descriptor                              Descriptor;
 
-    using point_attribute_internal::AppendAttributeOp;
+    using point_group_internal::AppendGroupAttributesOp;
     using point_group_internal::GroupInfo;
 
-    if (group.empty()) {
-        OPENVDB_THROW(KeyError, "Cannot use an empty group name as a key.");
+    for (std::vector<Name>::const_iterator  it = groups.begin(),
+                                            itEnd = groups.end(); it != itEnd; ++it) {
+        if (it->empty()) {
+            OPENVDB_THROW(KeyError, "Cannot use an empty group name as a key.");
+        }
     }
 
     typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
@@ -474,25 +781,43 @@ inline void appendGroup(PointDataTree& tree, const Name& group)
     Descriptor::Ptr descriptor = attributeSet.descriptorPtr();
     GroupInfo groupInfo(attributeSet);
 
-    // don't add if group already exists
+    // don't add groups that already exist or are repeated
 
-    if (descriptor->hasGroup(group))    return;
+    std::vector<Name> newGroups;
+    for (std::vector<Name>::const_iterator  it = groups.begin(),
+                                            itEnd = groups.end(); it != itEnd; ++it) {
+        if (descriptor->hasGroup(*it))  continue;
+        if (std::find(newGroups.begin(), newGroups.end(), *it) != newGroups.end())   continue;
+        newGroups.push_back(*it);
+    }
 
-    // add a new group attribute if there are no unused groups
+    if (newGroups.empty())  return;
 
-    if (groupInfo.unusedGroups() == 0) {
+    // add all the new group attributes needed to hold the groups in one pass
 
-        // find a new internal group name
+    const size_t unusedGroups = groupInfo.unusedGroups();
 
-        const Name groupName = descriptor->uniqueName("__group");
+    if (newGroups.size() > unusedGroups) {
 
-        descriptor = descriptor->duplicateAppend(groupName, GroupAttributeArray::attributeType());
+        const size_t groupBits = groupInfo.groupBits();
+        const size_t newAttributes = (newGroups.size() - unusedGroups + groupBits - 1) / groupBits;
 
-        const size_t pos = descriptor->find(groupName);
+        std::vector<size_t> positions;
 
-        // insert new group attribute
+        for (size_t i = 0; i < newAttributes; i++) {
 
-        AppendAttributeOp<PointDataTree> append(tree, descriptor, pos);
+            // find a new internal group name
+
+            const Name groupName = descriptor->uniqueName("__group");
+
+            descriptor = descriptor->duplicateAppend(groupName, GroupAttributeArray::attributeType());
+
+            positions.push_back(descriptor->find(groupName));
+        }
+
+        // insert new group attributes
+
+        AppendGroupAttributesOp<PointDataTree> append(descriptor, positions);
         tbb::parallel_for(typename tree::template LeafManager<PointDataTree>(tree).leafRange(), append);
     }
     else {
@@ -504,31 +829,17 @@ inline void appendGroup(PointDataTree& tree, const Name& group)
 
     // ensure that there are now available groups
 
-    assert(groupInfo.unusedGroups() > 0);
-
-    // find next unused offset
+    assert(groupInfo.unusedGroups() >= newGroups.size());
 
-    const size_t offset = groupInfo.nextUnusedOffset();
+    // add the group mappings to the descriptor using the next unused offsets
 
-    // add the group mapping to the descriptor
+    std::vector<size_t> offsets;
+    groupInfo.populateUnusedOffsets(offsets, newGroups.size());
 
-    descriptor->setGroup(group, offset);
-}
-
-
-////////////////////////////////////////
-
-
-template <typename PointDataTree>
-inline void appendGroups(PointDataTree& tree,
-                         const std::vector<Name>& groups)
-{
-    // TODO: could be more efficient by appending multiple groups at once
-    // instead of one-by-one, however this is likely not that common a use case
+    assert(offsets.size() == newGroups.size());
 
-    for (std::vector<Name>::const_iterator  it = groups.begin(),
-                                            itEnd = groups.end(); it != itEnd; ++it) {
-        appendGroup(tree, *it);
+    for (size_t i = 0; i < newGroups.size(); i++) {
+        descriptor->setGroup(newGroups[i], offsets[i]);
     }
 }
 
@@ -573,9 +884,31 @@ template <typename PointDataTree>
 inline void dropGroups( PointDataTree& tree,
                         const std::vector<Name>& groups)
 {
+    typedef AttributeSet::Descriptor                              Descriptor;
+
     for (std::vector<Name>::const_iterator  it = groups.begin(),
                                             itEnd = groups.end(); it != itEnd; ++it) {
-        dropGroup(tree, *it, /*compact=*/false);
+        if (it->empty()) {
+            OPENVDB_THROW(KeyError, "Cannot use an empty group name as a key.");
+        }
+    }
+
+    typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return;
+
+    const AttributeSet& attributeSet = iter->attributeSet();
+
+    // make the descriptor unique once before we modify the group map
+
+    makeDescriptorUnique(tree);
+    Descriptor::Ptr descriptor = attributeSet.descriptorPtr();
+
+    // now drop the groups
+
+    for (std::vector<Name>::const_iterator  it = groups.begin(),
+                                            itEnd = groups.end(); it != itEnd; ++it) {
+        descriptor->dropGroup(*it);
     }
 
     // compaction done once for efficiency
@@ -626,9 +959,8 @@ template <typename PointDataTree>
 inline void compactGroups(PointDataTree& tree)
 {
     typedef AttributeSet::Descriptor                              Descriptor;
-    typedef Descriptor::GroupIndex                                GroupIndex;
 
-    using point_group_internal::CopyGroupOp;
+    using point_group_internal::MoveGroupsOp;
     using point_group_internal::GroupInfo;
 
     typename PointDataTree::LeafCIter iter = tree.cbeginLeaf();
@@ -647,22 +979,28 @@ inline void compactGroups(PointDataTree& tree)
     makeDescriptorUnique(tree);
     Descriptor::Ptr descriptor = attributeSet.descriptorPtr();
 
-    // generate a list of group offsets and move them (one-by-one)
-    // TODO: improve this algorithm to move multiple groups per array at once
-    // though this is likely not that common a use case
+    // plan the moves of all groups up front and perform them in a single pass
 
-    Name sourceName;
-    size_t sourceOffset, targetOffset;
+    std::vector<GroupInfo::GroupMove> moves;
+    groupInfo.populateMoves(moves);
 
-    while (groupInfo.requiresMove(sourceName, sourceOffset, targetOffset)) {
+    if (!moves.empty()) {
 
-        const GroupIndex sourceIndex = attributeSet.groupIndex(sourceOffset);
-        const GroupIndex targetIndex = attributeSet.groupIndex(targetOffset);
+        std::vector<typename MoveGroupsOp<PointDataTree>::GroupMove> groupMoves;
 
-        CopyGroupOp<PointDataTree> copy(tree, targetIndex, sourceIndex);
-        tbb::parallel_for(typename tree::template LeafManager<PointDataTree>(tree).leafRange(), copy);
+        for (std::vector<GroupInfo::GroupMove>::const_iterator  it = moves.begin(),
+                                                                itEnd = moves.end(); it != itEnd; ++it) {
+            groupMoves.push_back(std::make_pair(attributeSet.groupIndex(it->sourceOffset),
+                                                attributeSet.groupIndex(it->targetOffset)));
+        }
 
-        descriptor->setGroup(sourceName, targetOffset);
+        MoveGroupsOp<PointDataTree> move(groupMoves);
+        tbb::parallel_for(typename tree::template LeafManager<PointDataTree>(tree).leafRange(), move);
+
+        for (std::vector<GroupInfo::GroupMove>::const_iterator  it = moves.begin(),
+                                                                itEnd = moves.end(); it != itEnd; ++it) {
+            descriptor->setGroup(it->name, it->targetOffset);
+        }
     }
 
     // drop unused attribute arrays
@@ -796,6 +1134,53 @@ inline void setGroupByFilter(   PointDataTree& tree,
 ////////////////////////////////////////
 
 
+template <typename PointDataTree>
+inline void setGroupByUnion(    PointDataTree& tree,
+                                const Name& group,
+                                const std::vector<Name>& sources)
+{
+    point_group_internal::setGroupByOperation(tree, group, sources,
+        point_group_internal::GROUP_UNION);
+}
+
+
+template <typename PointDataTree>
+inline void setGroupByIntersection( PointDataTree& tree,
+                                    const Name& group,
+                                    const std::vector<Name>& sources)
+{
+    point_group_internal::setGroupByOperation(tree, group, sources,
+        point_group_internal::GROUP_INTERSECTION);
+}
+
+
+template <typename PointDataTree>
+inline void setGroupByDifference(   PointDataTree& tree,
+                                    const Name& group,
+                                    const Name& source,
+                                    const std::vector<Name>& subtract)
+{
+    std::vector<Name> sources(1, source);
+    sources.insert(sources.end(), subtract.begin(), subtract.end());
+
+    point_group_internal::setGroupByOperation(tree, group, sources,
+        point_group_internal::GROUP_DIFFERENCE);
+}
+
+
+template <typename PointDataTree>
+inline void setGroupByComplement(   PointDataTree& tree,
+                                    const Name& group,
+                                    const Name& source)
+{
+    point_group_internal::setGroupByOperation(tree, group, std::vector<Name>(1, source),
+        point_group_internal::GROUP_COMPLEMENT);
+}
+
+
+////////////////////////////////////////
+
+
 template <typename PointDataTree>
 inline void setGroupByRandomTarget( PointDataTree& tree,
                                     const Name& group,
@@ -44,39 +44,362 @@
 #include <openvdb_points/tools/AttributeSet.h>
 #include <openvdb_points/tools/PointDataGrid.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm> // std::sort, std::unique
+#include <vector>
+
 namespace openvdb {
 OPENVDB_USE_VERSION_NAMESPACE
 namespace OPENVDB_VERSION_NAME {
 namespace tools {
 
 
-/// @brief Loads all leaf node voxel data in the given grid.
+/// @brief Loads all leaf node voxel data and attribute data in the given grid.
 ///
 /// @param grid  the Grid to be loaded.
-/// @note This method wraps readNonresidentBuffers().
 template <typename PointDataGridT>
 void loadPoints(PointDataGridT& grid);
 
 
-/// @brief Loads all leaf node voxel data in the given grid that
+/// @brief Loads all leaf node voxel data and attribute data in the given grid that
 /// overlap with mask grid leaf nodes.
 ///
-/// @param grid  the Grid to be loaded.
-/// @param mask  the mask to denote region of points to load
+/// @param grid      the Grid to be loaded.
+/// @param mask      the mask to denote region of points to load
+/// @param prefetch  if true, advise the operating system to read ahead all the data
+///                  to be loaded before loading it
 template <typename PointDataGridT, typename MaskGridT>
-void loadPoints(PointDataGridT& grid, const MaskGridT& mask);
+void loadPoints(PointDataGridT& grid, const MaskGridT& mask, const bool prefetch = false);
 
 
-/// @brief Load the leaf node voxel data in the given grid that
+/// @brief Load the leaf node voxel data and attribute data in the given grid that
 /// overlap with a world-space bounding box.
 ///
-/// @param grid  the Grid to be loaded.
-/// @param bbox  the bbox to denote region of points to load
+/// @param grid      the Grid to be loaded.
+/// @param bbox      the bbox to denote region of points to load
+/// @param prefetch  if true, advise the operating system to read ahead all the data
+///                  to be loaded before loading it
 ///
 /// @note Does not clip to the bounding box, leaf nodes with any
 /// overlap will be loaded.
 template <typename PointDataGridT>
-void loadPoints(PointDataGridT& grid, const BBoxd& bbox);
+void loadPoints(PointDataGridT& grid, const BBoxd& bbox, const bool prefetch = false);
+
+
+/// @brief Loads the leaf node voxel data and only the requested attributes in the given grid,
+/// all other attributes remain out-of-core.
+///
+/// @param grid        the Grid to be loaded.
+/// @param attributes  names of the attributes to load
+/// @param groups      names of groups whose membership data is to be loaded
+/// @param prefetch    if true, advise the operating system to read ahead all the data
+///                    to be loaded before loading it
+template <typename PointDataGridT>
+void loadAttributes(PointDataGridT& grid, const std::vector<Name>& attributes,
+                    const std::vector<Name>& groups = std::vector<Name>(),
+                    const bool prefetch = false);
+
+
+/// @brief Loads the leaf node voxel data and only the requested attributes in the given grid
+/// that overlap with mask grid leaf nodes, all other attributes remain out-of-core.
+///
+/// @param grid        the Grid to be loaded.
+/// @param mask        the mask to denote region of points to load
+/// @param attributes  names of the attributes to load
+/// @param groups      names of groups whose membership data is to be loaded
+/// @param prefetch    if true, advise the operating system to read ahead all the data
+///                    to be loaded before loading it
+template <typename PointDataGridT, typename MaskGridT>
+void loadAttributes(PointDataGridT& grid, const MaskGridT& mask,
+                    const std::vector<Name>& attributes,
+                    const std::vector<Name>& groups = std::vector<Name>(),
+                    const bool prefetch = false);
+
+
+/// @brief Loads the leaf node voxel data and only the requested attributes in the given grid
+/// that overlap with a world-space bounding box, all other attributes remain out-of-core.
+///
+/// @param grid        the Grid to be loaded.
+/// @param bbox        the bbox to denote region of points to load
+/// @param attributes  names of the attributes to load
+/// @param groups      names of groups whose membership data is to be loaded
+/// @param prefetch    if true, advise the operating system to read ahead all the data
+///                    to be loaded before loading it
+///
+/// @note Does not clip to the bounding box, leaf nodes with any
+/// overlap will be loaded.
+template <typename PointDataGridT>
+void loadAttributes(PointDataGridT& grid, const BBoxd& bbox,
+                    const std::vector<Name>& attributes,
+                    const std::vector<Name>& groups = std::vector<Name>(),
+                    const bool prefetch = false);
+
+
+/// @brief Releases the in-memory data of unmodified, delay-loaded attribute arrays in the
+/// given grid back to disk, least recently used first, until the memory used by all
+/// attribute arrays in the grid is within the given budget.
+///
+/// @param grid          the Grid whose attributes are to be released.
+/// @param memoryBudget  the maximum number of bytes of attribute data to keep in memory,
+///                      a budget of zero releases every array that can be released.
+///
+/// @return the number of bytes released.
+///
+/// @note Released arrays are re-loaded from the file when next accessed. Arrays that have
+/// been modified since they were loaded cannot be released.
+/// @note The grid must not be accessed by other threads while attributes are released.
+template <typename PointDataGridT>
+Index64 releaseAttributes(PointDataGridT& grid, const Index64 memoryBudget = 0);
+
+
+////////////////////////////////////////
+
+
+namespace point_load_internal {
+
+
+template <typename LeafT>
+struct PrefetchLeafOp
+{
+    typedef std::vector<const LeafT*>   LeafVec;
+    typedef std::vector<size_t>         Indices;
+
+    PrefetchLeafOp(const LeafVec& leaves, const Indices* indices)
+        : mLeaves(leaves)
+        , mIndices(indices) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t n = range.begin(), N = range.end(); n < N; ++n) {
+            const AttributeSet& attributeSet = mLeaves[n]->attributeSet();
+            const size_t size = mIndices ? mIndices->size() : attributeSet.size();
+            for (size_t i = 0; i < size; i++) {
+                attributeSet.getConst(mIndices ? (*mIndices)[i] : i)->prefetchData();
+            }
+        }
+    }
+
+    //////////
+
+    const LeafVec&      mLeaves;
+    const Indices*      mIndices;
+}; // struct PrefetchLeafOp
+
+
+template <typename LeafT>
+struct LoadLeafOp
+{
+    typedef std::vector<const LeafT*>   LeafVec;
+    typedef std::vector<size_t>         Indices;
+
+    LoadLeafOp(const LeafVec& leaves, const Indices* indices)
+        : mLeaves(leaves)
+        , mIndices(indices) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t n = range.begin(), N = range.end(); n < N; ++n) {
+            const LeafT& leaf = *mLeaves[n];
+
+            // load out of core leaf nodes
+            if (leaf.buffer().isOutOfCore())    leaf.buffer().data();
+
+            // load out of core attribute arrays (all if no indices are provided)
+            const AttributeSet& attributeSet = leaf.attributeSet();
+            const size_t size = mIndices ? mIndices->size() : attributeSet.size();
+            for (size_t i = 0; i < size; i++) {
+                attributeSet.getConst(mIndices ? (*mIndices)[i] : i)->loadData();
+            }
+        }
+    }
+
+    //////////
+
+    const LeafVec&      mLeaves;
+    const Indices*      mIndices;
+}; // struct LoadLeafOp
+
+
+/// Load the voxel and attribute data of the given leaf nodes in parallel,
+/// only the attributes at the given indices are loaded if provided
+template <typename LeafT>
+void loadLeaves(const std::vector<const LeafT*>& leaves, const bool prefetch,
+                const std::vector<size_t>* indices = NULL)
+{
+    if (leaves.empty())     return;
+
+    const tbb::blocked_range<size_t> range(0, leaves.size());
+
+    if (prefetch)   tbb::parallel_for(range, PrefetchLeafOp<LeafT>(leaves, indices));
+
+    tbb::parallel_for(range, LoadLeafOp<LeafT>(leaves, indices));
+}
+
+
+/// Collect all leaf nodes in the tree
+template <typename TreeT>
+void collectLeaves(const TreeT& tree, std::vector<const typename TreeT::LeafNodeType*>& leaves)
+{
+    leaves.reserve(tree.leafCount());
+
+    typename TreeT::LeafCIter leafIter = tree.cbeginLeaf();
+
+    for (; leafIter; ++leafIter)    leaves.push_back(leafIter.getLeaf());
+}
+
+
+/// Collect the leaf nodes in the tree that overlap with mask grid leaf nodes
+template <typename TreeT, typename MaskGridT>
+void collectLeaves( const TreeT& tree, const MaskGridT& mask,
+                    std::vector<const typename TreeT::LeafNodeType*>& leaves)
+{
+    typedef typename TreeT::LeafNodeType LeafT;
+
+    tree::ValueAccessor<const TreeT> pointsAcc(tree);
+
+    typename MaskGridT::TreeType::LeafCIter leafIter = mask.constTree().cbeginLeaf();
+
+    for (; leafIter; ++leafIter) {
+        const Coord& ijk = leafIter->origin();
+        const LeafT* leaf = pointsAcc.probeConstLeaf(ijk);
+
+        if (leaf)   leaves.push_back(leaf);
+    }
+}
+
+
+/// Collect the leaf nodes in the tree that overlap with an index-space bounding box
+template <typename TreeT>
+void collectLeaves( const TreeT& tree, const CoordBBox& region,
+                    std::vector<const typename TreeT::LeafNodeType*>& leaves)
+{
+    typedef typename TreeT::LeafNodeType LeafT;
+
+    if (region.empty())     return;
+
+    // collect the leaf nodes that overlap the region, either by probing each leaf
+    // node location in the region or by iterating over all leaf nodes, whichever is fewer
+
+    // the region isn't clamped to the active bounds of the tree, as leaf nodes that
+    // only contain inactive points must still be collected
+
+    const Coord leafMin = region.min() >> LeafT::LOG2DIM;
+    const Coord leafMax = region.max() >> LeafT::LOG2DIM;
+    const double regionLeafCount = (double(leafMax.x()) - double(leafMin.x()) + 1.0) *
+                                   (double(leafMax.y()) - double(leafMin.y()) + 1.0) *
+                                   (double(leafMax.z()) - double(leafMin.z()) + 1.0);
+
+    const Index64 leafCount = tree.leafCount();
+
+    if (regionLeafCount < double(leafCount)) {
+        tree::ValueAccessor<const TreeT> pointsAcc(tree);
+
+        Coord ijk;
+        for (ijk.x() = leafMin.x(); ijk.x() <= leafMax.x(); ++ijk.x()) {
+            for (ijk.y() = leafMin.y(); ijk.y() <= leafMax.y(); ++ijk.y()) {
+                for (ijk.z() = leafMin.z(); ijk.z() <= leafMax.z(); ++ijk.z()) {
+                    const LeafT* leaf = pointsAcc.probeConstLeaf(ijk << LeafT::LOG2DIM);
+                    if (leaf)   leaves.push_back(leaf);
+                }
+            }
+        }
+    }
+    else {
+        typename TreeT::LeafCIter leafIter = tree.cbeginLeaf();
+
+        for (; leafIter; ++leafIter) {
+            if (region.hasOverlap(leafIter->getNodeBoundingBox())) {
+                leaves.push_back(leafIter.getLeaf());
+            }
+        }
+    }
+}
+
+
+/// Transform a world-space bounding box into the grid's index space
+template <typename GridT>
+CoordBBox indexSpaceBBox(const GridT& grid, const BBoxd& bbox)
+{
+    Vec3d idxMin, idxMax;
+    math::calculateBounds(grid.constTransform(), bbox.min(), bbox.max(), idxMin, idxMax);
+    return CoordBBox(Coord::floor(idxMin), Coord::floor(idxMax));
+}
+
+
+/// Return the sorted, unique attribute indices of the named attributes and of the
+/// group attributes that store the named groups
+template <typename TreeT>
+std::vector<size_t> attributeIndices(   const TreeT& tree,
+                                        const std::vector<Name>& attributes,
+                                        const std::vector<Name>& groups)
+{
+    std::vector<size_t> indices;
+
+    typename TreeT::LeafCIter iter = tree.cbeginLeaf();
+
+    if (!iter)  return indices;
+
+    const AttributeSet& attributeSet = iter->attributeSet();
+    const AttributeSet::Descriptor& descriptor = attributeSet.descriptor();
+
+    for (std::vector<Name>::const_iterator it = attributes.begin(); it != attributes.end(); ++it) {
+        const size_t index = descriptor.find(*it);
+        if (index == AttributeSet::INVALID_POS) {
+            OPENVDB_THROW(KeyError, "Cannot find requested attribute - " << *it << ".");
+        }
+        indices.push_back(index);
+    }
+
+    for (std::vector<Name>::const_iterator it = groups.begin(); it != groups.end(); ++it) {
+        indices.push_back(attributeSet.groupIndex(*it).first);
+    }
+
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    return indices;
+}
+
+
+/// An attribute array that may be released, ordered by most recent access
+struct ReleaseCandidate
+{
+    ReleaseCandidate(AttributeArray* _array = NULL)
+        : array(_array)
+        , stamp(_array ? _array->accessStamp() : 0)
+        , bytes(_array ? _array->memUsage() : 0) { }
+
+    bool operator<(const ReleaseCandidate& rhs) const { return stamp < rhs.stamp; }
+
+    AttributeArray* array;
+    Index64 stamp;
+    size_t bytes;
+};
+
+
+struct ReleaseArrayOp
+{
+    typedef std::vector<ReleaseCandidate>   CandidateVec;
+
+    ReleaseArrayOp(const CandidateVec& candidates)
+        : mCandidates(candidates) { }
+
+    void operator()(const tbb::blocked_range<size_t>& range) const
+    {
+        for (size_t n = range.begin(), N = range.end(); n < N; ++n) {
+            mCandidates[n].array->releaseData();
+        }
+    }
+
+    //////////
+
+    const CandidateVec& mCandidates;
+}; // struct ReleaseArrayOp
+
+
+} // namespace point_load_internal
 
 
 ////////////////////////////////////////
@@ -86,7 +409,12 @@ void loadPoints(PointDataGridT& grid, const BBoxd& bbox);
 template <typename PointDataGridT>
 void loadPoints(PointDataGridT& grid)
 {
-    grid.constTree().readNonresidentBuffers();
+    typedef typename PointDataGridT::TreeType::LeafNodeType LeafT;
+
+    std::vector<const LeafT*> leaves;
+    point_load_internal::collectLeaves(grid.constTree(), leaves);
+
+    point_load_internal::loadLeaves(leaves, /*prefetch=*/false);
 }
 #else
 template <typename PointDataGridT>
@@ -98,53 +426,160 @@ void loadPoints(PointDataGridT&)
 
 
 template <typename PointDataGridT, typename MaskGridT>
-void loadPoints(PointDataGridT& grid, const MaskGridT& mask)
+void loadPoints(PointDataGridT& grid, const MaskGridT& mask, const bool prefetch)
 {
-    typedef typename PointDataGridT::TreeType PointDataTreeT;
+    typedef typename PointDataGridT::TreeType::LeafNodeType LeafT;
 
-    tree::ValueAccessor<const PointDataTreeT> pointsAcc(grid.constTree());
+    std::vector<const LeafT*> leaves;
+    point_load_internal::collectLeaves(grid.constTree(), mask, leaves);
 
-    typename MaskGridT::TreeType::LeafCIter leafIter = mask.constTree().cbeginLeaf();
+    point_load_internal::loadLeaves(leaves, prefetch);
+}
 
-    for (; leafIter; ++leafIter) {
-        const Coord& ijk = leafIter->origin();
-        const typename PointDataTreeT::LeafNodeType* leaf = pointsAcc.probeConstLeaf(ijk);
 
-        if (!leaf)  continue;
+template <typename PointDataGridT>
+void loadPoints(PointDataGridT& grid, const BBoxd& bbox, const bool prefetch)
+{
+    typedef typename PointDataGridT::TreeType::LeafNodeType LeafT;
 
-        // load out of core leaf nodes
-        if (leaf->buffer().isOutOfCore())    leaf->buffer().data();
-    }
+    const CoordBBox region = point_load_internal::indexSpaceBBox(grid, bbox);
+
+    std::vector<const LeafT*> leaves;
+    point_load_internal::collectLeaves(grid.constTree(), region, leaves);
+
+    point_load_internal::loadLeaves(leaves, prefetch);
 }
 
 
 template <typename PointDataGridT>
-void loadPoints(PointDataGridT& grid, const BBoxd& bbox)
+void loadAttributes(PointDataGridT& grid, const std::vector<Name>& attributes,
+                    const std::vector<Name>& groups, const bool prefetch)
 {
-    typedef typename PointDataGridT::template ValueConverter<bool>::Type BoolGridT;
+    typedef typename PointDataGridT::TreeType::LeafNodeType LeafT;
 
-    // Transform the world-space bounding box into the source grid's index space.
-    Vec3d idxMin, idxMax;
-    math::calculateBounds(grid.constTransform(), bbox.min(), bbox.max(), idxMin, idxMax);
-    CoordBBox region(Coord::floor(idxMin), Coord::floor(idxMax));
+    const std::vector<size_t> indices =
+        point_load_internal::attributeIndices(grid.constTree(), attributes, groups);
+
+    std::vector<const LeafT*> leaves;
+    point_load_internal::collectLeaves(grid.constTree(), leaves);
+
+    point_load_internal::loadLeaves(leaves, prefetch, &indices);
+}
+
+
+template <typename PointDataGridT, typename MaskGridT>
+void loadAttributes(PointDataGridT& grid, const MaskGridT& mask,
+                    const std::vector<Name>& attributes,
+                    const std::vector<Name>& groups, const bool prefetch)
+{
+    typedef typename PointDataGridT::TreeType::LeafNodeType LeafT;
+
+    const std::vector<size_t> indices =
+        point_load_internal::attributeIndices(grid.constTree(), attributes, groups);
+
+    std::vector<const LeafT*> leaves;
+    point_load_internal::collectLeaves(grid.constTree(), mask, leaves);
 
-    // Construct a boolean mask grid that is true inside the index-space bounding box
-    // and false everywhere else.
-    BoolGridT clipMask(/*background=*/false);
-    clipMask.fill(region, /*value=*/true, /*active=*/true);
+    point_load_internal::loadLeaves(leaves, prefetch, &indices);
+}
+
+
+template <typename PointDataGridT>
+void loadAttributes(PointDataGridT& grid, const BBoxd& bbox,
+                    const std::vector<Name>& attributes,
+                    const std::vector<Name>& groups, const bool prefetch)
+{
+    typedef typename PointDataGridT::TreeType::LeafNodeType LeafT;
+
+    const std::vector<size_t> indices =
+        point_load_internal::attributeIndices(grid.constTree(), attributes, groups);
 
-    // MaskGrid introduced in OpenVDB 3.2
-    typedef BoolGrid MaskType;
+    const CoordBBox region = point_load_internal::indexSpaceBBox(grid, bbox);
 
-    // Convert the input grid to a mask grid (with the same tree configuration).
-    MaskType::Ptr pointsMask = MaskType::create(/*background=*/false);
-    pointsMask->topologyUnion(grid);
-    pointsMask->topologyIntersection(clipMask);
+    std::vector<const LeafT*> leaves;
+    point_load_internal::collectLeaves(grid.constTree(), region, leaves);
 
-    loadPoints(grid, *pointsMask);
+    point_load_internal::loadLeaves(leaves, prefetch, &indices);
 }
 
 
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+template <typename PointDataGridT>
+Index64 releaseAttributes(PointDataGridT& grid, const Index64 memoryBudget)
+{
+    typedef point_load_internal::ReleaseCandidate ReleaseCandidate;
+
+    // collect the unique attribute arrays, as arrays may be shared between leaf nodes
+
+    std::vector<const AttributeArray*> arrays;
+
+    typename PointDataGridT::TreeType::LeafCIter leafIter = grid.constTree().cbeginLeaf();
+
+    for (; leafIter; ++leafIter) {
+        const AttributeSet& attributeSet = leafIter->attributeSet();
+        for (size_t i = 0; i < attributeSet.size(); i++) {
+            arrays.push_back(attributeSet.getConst(i));
+        }
+    }
+
+    std::sort(arrays.begin(), arrays.end());
+    arrays.erase(std::unique(arrays.begin(), arrays.end()), arrays.end());
+
+    // total the memory used by all arrays, whether they can be released or not
+
+    Index64 totalBytes = 0;
+
+    std::vector<ReleaseCandidate> candidates;
+
+    for (std::vector<const AttributeArray*>::const_iterator it = arrays.begin();
+        it != arrays.end(); ++it) {
+
+        // releasing an array leaves its values unchanged, so shared arrays are
+        // released in-place rather than made unique
+
+        const ReleaseCandidate candidate(const_cast<AttributeArray*>(*it));
+        totalBytes += candidate.bytes;
+        if (candidate.array->isReleasable())    candidates.push_back(candidate);
+    }
+
+    if (totalBytes <= memoryBudget)     return 0;
+
+    // release the least recently used arrays until within budget
+
+    std::sort(candidates.begin(), candidates.end());
+
+    Index64 releasedBytes = 0;
+    size_t count = 0;
+
+    for (; count < candidates.size() && totalBytes - releasedBytes > memoryBudget; count++) {
+        releasedBytes += candidates[count].bytes;
+    }
+
+    candidates.resize(count);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, candidates.size()),
+        point_load_internal::ReleaseArrayOp(candidates));
+
+    // measure the memory actually released, as released arrays retain a small footprint
+
+    releasedBytes = 0;
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        releasedBytes += candidates[i].bytes - candidates[i].array->memUsage();
+    }
+
+    return releasedBytes;
+}
+#else
+template <typename PointDataGridT>
+Index64 releaseAttributes(PointDataGridT&, const Index64)
+{
+    // out-of-core not supported with ABI 2
+    return 0;
+}
+#endif
+
+
 ////////////////////////////////////////
 
 
@@ -38,8 +38,10 @@
 
 #include "ProfileTimer.h"
 
+#include <limits>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 // Boost.Interprocess uses a header-only portion of Boost.DateTime
 #define BOOST_DATE_TIME_NO_LIB
@@ -51,6 +53,7 @@
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/version.hpp> // for BOOST_VERSION
+#include <boost/weak_ptr.hpp>
 
 #include <tbb/atomic.h>
 
@@ -102,6 +105,24 @@ private:
 }; // class ProxyMappedFile
 
 
+/// @brief Records the codec and the first value of a typed attribute array during codec dispatch
+template <typename ValueType>
+struct TypedArrayCodecOp
+{
+    TypedArrayCodecOp() : mCodec("none"), mValue(openvdb::zeroVal<ValueType>()) { }
+
+    template <typename TypedAttributeArrayT>
+    void operator()(const TypedAttributeArrayT& array)
+    {
+        mCodec = TypedAttributeArrayT::Codec::name();
+        mValue = array.get(0);
+    }
+
+    std::string mCodec;
+    ValueType mValue;
+}; // struct TypedArrayCodecOp
+
+
 using namespace openvdb;
 using namespace openvdb::tools;
 
@@ -119,6 +140,9 @@ public:
     CPPUNIT_TEST(testDelayedLoad);
     CPPUNIT_TEST(testQuaternions);
     CPPUNIT_TEST(testMatrices);
+    CPPUNIT_TEST(testDeltaPack);
+    CPPUNIT_TEST(testQuantizedPositions);
+    CPPUNIT_TEST(testSparse);
     CPPUNIT_TEST(testProfile);
 
     CPPUNIT_TEST_SUITE_END();
@@ -133,6 +157,9 @@ public:
     void testDelayedLoad();
     void testQuaternions();
     void testMatrices();
+    void testDeltaPack();
+    void testQuantizedPositions();
+    void testSparse();
     void testProfile();
 }; // class TestAttributeArray
 
@@ -254,6 +281,26 @@ TestAttributeArray::testRegistry()
         AttributeArray::clearRegistry();
         CPPUNIT_ASSERT(!AttributeArray::isRegistered(AttributeF::attributeType()));
     }
+
+    { // registering each of the codecs of a value type
+        registerTypedAttributeArrays<math::Vec3<float> >();
+
+        CPPUNIT_ASSERT((TypedAttributeArray<math::Vec3<float> >::isRegistered()));
+        CPPUNIT_ASSERT((TypedAttributeArray<math::Vec3<float>, TruncateCodec>::isRegistered()));
+        CPPUNIT_ASSERT((TypedAttributeArray<math::Vec3<float>, FixedPointCodec<true> >::isRegistered()));
+        CPPUNIT_ASSERT((TypedAttributeArray<math::Vec3<float>, FixedPointCodec<false> >::isRegistered()));
+        CPPUNIT_ASSERT((TypedAttributeArray<math::Vec3<float>, UnitVecCodec>::isRegistered()));
+        CPPUNIT_ASSERT((TypedAttributeArray<math::Vec3<float>, QuantizedPositionCodec>::isRegistered()));
+
+        CPPUNIT_ASSERT(!(TypedAttributeArray<float, TruncateCodec>::isRegistered()));
+
+        registerTypedAttributeArrays<int32_t>();
+
+        CPPUNIT_ASSERT((TypedAttributeArray<int32_t>::isRegistered()));
+        CPPUNIT_ASSERT((TypedAttributeArray<int32_t, DeltaPackCodec>::isRegistered()));
+
+        AttributeArray::clearRegistry();
+    }
 }
 
 void
@@ -380,6 +427,20 @@ TestAttributeArray::testCompression()
             CPPUNIT_ASSERT_EQUAL(uncompressedBuffer[i], reinterpret_cast<const int*>(newUncompressedBuffer)[i]);
         }
 
+        // decompress into a provided buffer
+
+        int* outBuffer = new int[count];
+
+        CPPUNIT_ASSERT(decompress(compressedBuffer, reinterpret_cast<char*>(outBuffer), uncompressedBytes));
+
+        for (int i = 0; i < count; i++) {
+            CPPUNIT_ASSERT_EQUAL(uncompressedBuffer[i], outBuffer[i]);
+        }
+
+        CPPUNIT_ASSERT_THROW(decompress(compressedBuffer, reinterpret_cast<char*>(outBuffer), uncompressedBytes - 4),
+                                        openvdb::RuntimeError);
+
+        delete[] outBuffer;
         delete[] uncompressedBuffer;
         delete[] compressedBuffer;
         delete[] newUncompressedBuffer;
@@ -401,6 +462,119 @@ TestAttributeArray::testCompression()
         delete[] uncompressedBuffer;
 #endif
     }
+
+    { // compression settings
+        typedef openvdb::tools::TypedAttributeArray<int> AttributeArrayI;
+
+        AttributeArrayI attr(count);
+
+        for (int i = 0; i < count; i++) {
+            attr.set(i, i / 2);
+        }
+
+        CPPUNIT_ASSERT(attr.compressionSettings() == Settings());
+
+        const Settings settings(Settings::BLOSCLZ, /*level=*/1, Settings::NOSHUFFLE, /*blockSize=*/0);
+
+        attr.setCompressionSettings(settings);
+
+        CPPUNIT_ASSERT(attr.compressionSettings() == settings);
+        CPPUNIT_ASSERT(attr.compressionSettings() != Settings());
+        CPPUNIT_ASSERT_EQUAL(std::string("blosclz"), std::string(settings.compressorName()));
+
+        // settings are preserved on copy
+
+        AttributeArrayI attrB(attr);
+        CPPUNIT_ASSERT(attrB.compressionSettings() == settings);
+
+        // invalid settings
+
+        CPPUNIT_ASSERT_THROW(attr.setCompressionSettings(Settings(Settings::LZ4, 10)), openvdb::ValueError);
+        CPPUNIT_ASSERT(attr.compressionSettings() == settings);
+
+#ifdef OPENVDB_USE_BLOSC
+        // compression uses the settings
+
+        CPPUNIT_ASSERT(attr.compress());
+        CPPUNIT_ASSERT(attr.isCompressed());
+
+        for (int i = 0; i < count; i++) {
+            CPPUNIT_ASSERT_EQUAL(i / 2, attr.get(i));
+        }
+
+        // no compression (level zero) cannot reduce the size
+
+        const size_t uncompressedBytes = count * sizeof(int);
+
+        int* buffer = new int[count];
+        for (int i = 0; i < count; i++)     buffer[i] = i / 2;
+
+        const size_t storedBytes = compressedSize(reinterpret_cast<const char*>(buffer), sizeof(int),
+            uncompressedBytes, Settings(Settings::LZ4, /*level=*/0));
+        const size_t compressedBytes = compressedSize(reinterpret_cast<const char*>(buffer), sizeof(int),
+            uncompressedBytes, Settings(Settings::LZ4, /*level=*/9));
+
+        CPPUNIT_ASSERT(storedBytes >= uncompressedBytes);
+        CPPUNIT_ASSERT(compressedBytes < uncompressedBytes);
+
+        delete[] buffer;
+#endif
+    }
+
+    { // multi-threaded compression of large buffers
+        CPPUNIT_ASSERT(maxThreads() > 0);
+
+        setMaxThreads(4);
+        CPPUNIT_ASSERT_EQUAL(4, maxThreads());
+
+#ifdef OPENVDB_USE_BLOSC
+        const int largeCount = 4 * 1024 * 1024;
+        const size_t uncompressedBytes = largeCount * sizeof(int);
+
+        int* uncompressedBuffer = new int[largeCount];
+
+        for (int i = 0; i < largeCount; i++) {
+            uncompressedBuffer[i] = i / 2;
+        }
+
+        size_t compressedBytes;
+        char* compressedBuffer = 0;
+
+        { // scopes can be nested
+            ScopedThreads threads;
+            ScopedThreads nestedThreads;
+
+            compressedBuffer = compress(reinterpret_cast<const char*>(uncompressedBuffer), sizeof(int),
+                                        uncompressedBytes, compressedBytes);
+        }
+
+        CPPUNIT_ASSERT(compressedBuffer);
+        CPPUNIT_ASSERT(compressedBytes < uncompressedBytes);
+
+        // output matches compressing with a single thread
+
+        CPPUNIT_ASSERT_EQUAL(compressedBytes, compressedSize(reinterpret_cast<const char*>(uncompressedBuffer),
+                                                            sizeof(int), uncompressedBytes));
+
+        int* outBuffer = new int[largeCount];
+
+        {
+            ScopedThreads threads;
+
+            CPPUNIT_ASSERT(decompress(compressedBuffer, reinterpret_cast<char*>(outBuffer), uncompressedBytes));
+        }
+
+        for (int i = 0; i < largeCount; i++) {
+            CPPUNIT_ASSERT_EQUAL(uncompressedBuffer[i], outBuffer[i]);
+        }
+
+        delete[] outBuffer;
+        delete[] compressedBuffer;
+        delete[] uncompressedBuffer;
+#endif
+
+        setMaxThreads(0);
+    }
 }
 
 void
@@ -1025,6 +1199,72 @@ TestAttributeArray::testAttributeHandle()
 
         CPPUNIT_ASSERT(array->isCompressed());
 
+        { // read-only handles reuse the most recent decompression of unchanged data
+            AttributeHandle<float> handle1(*array);
+            AttributeHandle<float> handle2(*array);
+
+            CPPUNIT_ASSERT(handle1.mLocalArray);
+            CPPUNIT_ASSERT_EQUAL(handle1.mLocalArray.get(), handle2.mLocalArray.get());
+            CPPUNIT_ASSERT(!handle1.mLocalArray->isCompressed());
+            CPPUNIT_ASSERT_EQUAL(handle2.get(6), float(11));
+
+            // modifying and re-compressing the array invalidates the decompression
+
+            array->decompress();
+            AttributeFH::cast(*array).set(6, float(12));
+            array->compress();
+
+            AttributeHandle<float> handle3(*array);
+
+            CPPUNIT_ASSERT(handle3.mLocalArray.get() != handle1.mLocalArray.get());
+            CPPUNIT_ASSERT_EQUAL(handle1.get(6), float(11));
+            CPPUNIT_ASSERT_EQUAL(handle3.get(6), float(12));
+
+            array->decompress();
+            AttributeFH::cast(*array).set(6, float(11));
+            array->compress();
+
+            // with the cache disabled each handle decompresses its own copy
+
+            AttributeArray::setDecompressionCache(false);
+            CPPUNIT_ASSERT(!AttributeArray::decompressionCache());
+
+            AttributeHandle<float> handle4(*array);
+            AttributeHandle<float> handle5(*array);
+
+            CPPUNIT_ASSERT(handle4.mLocalArray.get() != handle5.mLocalArray.get());
+            CPPUNIT_ASSERT_EQUAL(handle5.get(6), float(11));
+
+            AttributeArray::setDecompressionCache(true);
+            AttributeArray::clearDecompressionCache();
+        }
+
+        { // decompressions are released once their compressed data no longer exists
+            AttributeArray::Ptr temp = array->copy();
+            temp->decompress();
+            temp->compress();
+
+            boost::weak_ptr<AttributeArray> cached;
+
+            {
+                AttributeHandle<float> handle(*temp);
+                CPPUNIT_ASSERT(handle.mLocalArray);
+                cached = handle.mLocalArray;
+            }
+
+            CPPUNIT_ASSERT(!cached.expired());
+
+            temp.reset();
+
+            AttributeHandle<float> handle(*array);
+
+            CPPUNIT_ASSERT(cached.expired());
+
+            AttributeArray::clearDecompressionCache();
+        }
+
+        CPPUNIT_ASSERT(array->isCompressed());
+
         {
             AttributeHandle<float> handleRO(*array, /*preserveCompression=*/false);
 
@@ -1058,6 +1298,240 @@ TestAttributeArray::testAttributeHandle()
 
         CPPUNIT_ASSERT_EQUAL(array->get(6), float(11));
     }
+
+    // check range access
+
+    {
+        AttributeI::Ptr attr = AttributeI::create(count);
+
+        std::vector<int> values(count);
+        for (unsigned i = 0; i < count; ++i)    values[i] = int(i);
+
+        // uniform arrays decode every value to the uniform value
+
+        std::vector<int> result(count, -1);
+        attr->getRange(0, count, &result[0]);
+
+        for (unsigned i = 0; i < count; ++i)    CPPUNIT_ASSERT_EQUAL(result[i], 0);
+
+        attr->setRange(0, count, &values[0]);
+
+        CPPUNIT_ASSERT(!attr->isUniform());
+        CPPUNIT_ASSERT_EQUAL(attr->get(10), 10);
+
+        CPPUNIT_ASSERT_THROW(attr->getRange(count - 5, 10, &result[0]), openvdb::IndexError);
+        CPPUNIT_ASSERT_THROW(attr->setRange(count - 5, 10, &values[0]), openvdb::IndexError);
+
+        AttributeHandle<int> handle(*attr);
+
+        handle.getRange(5, 10, &result[0]);
+
+        for (unsigned i = 0; i < 10; ++i)   CPPUNIT_ASSERT_EQUAL(result[i], int(i + 5));
+
+        AttributeHandle<int, NullCodec> nullHandle(*attr);
+
+        nullHandle.getRange(20, 10, &result[0]);
+
+        for (unsigned i = 0; i < 10; ++i)   CPPUNIT_ASSERT_EQUAL(result[i], int(i + 20));
+
+        AttributeWriteHandle<int, NullCodec> writeHandle(*attr);
+
+        writeHandle.setRange(0, 2, &values[20]);
+
+        CPPUNIT_ASSERT_EQUAL(attr->get(0), 20);
+        CPPUNIT_ASSERT_EQUAL(attr->get(1), 21);
+        CPPUNIT_ASSERT_EQUAL(attr->get(2), 2);
+    }
+
+    {
+        AttributeFH::Ptr attr = AttributeFH::create(count, /*stride=*/3);
+
+        std::vector<float> values(count * 3);
+        for (unsigned i = 0; i < count * 3; ++i)    values[i] = float(i);
+
+        std::vector<float> result(6);
+
+        {
+            AttributeWriteHandle<float, UnknownCodec, /*Strided=*/true> handle(*attr);
+
+            handle.setRange(0, count, &values[0]);
+
+            CPPUNIT_ASSERT_EQUAL(handle.get(2, 1), float(7));
+
+            handle.getRange(2, 2, &result[0]);
+
+            for (unsigned i = 0; i < 6; ++i)    CPPUNIT_ASSERT_EQUAL(result[i], float(i + 6));
+        }
+
+        attr->setInterleaved(true);
+
+        {
+            AttributeWriteHandle<float, TruncateCodec, /*Strided=*/true, /*Interleaved=*/true> handle(*attr);
+
+            handle.setRange(0, count, &values[0]);
+
+            CPPUNIT_ASSERT_EQUAL(handle.get(2, 1), float(7));
+            CPPUNIT_ASSERT_EQUAL(attr->get(count + 2), float(7));
+
+            handle.getRange(2, 2, &result[0]);
+
+            for (unsigned i = 0; i < 6; ++i)    CPPUNIT_ASSERT_EQUAL(result[i], float(i + 6));
+        }
+    }
+
+    // check batched range decoding and encoding matches the scalar codecs
+    // (an odd length ensures both the batched and the scalar remainder are used)
+
+    {
+        typedef TypedAttributeArray<float, FixedPointCodec<true> >      AttributeFP8;
+        typedef TypedAttributeArray<float, FixedPointCodec<false> >     AttributeFP16;
+        typedef TypedAttributeArray<Vec3f, FixedPointCodec<false> >     AttributeVec3fFP16;
+        typedef TypedAttributeArray<Vec3f, TruncateCodec>               AttributeVec3fH;
+
+        const unsigned length = 53;
+
+        std::vector<float> values(length);
+        std::vector<Vec3f> vectors(length);
+        for (unsigned i = 0; i < length; ++i) {
+            values[i] = float(i) / float(length) - 0.5f;
+            vectors[i] = Vec3f(values[i], -values[i], values[i] * 0.5f);
+        }
+
+        std::vector<float> result(length);
+        std::vector<Vec3f> vectorResult(length);
+
+        AttributeFP8 fp8(length);
+        fp8.setRange(0, length, &values[0]);
+        fp8.getRange(0, length, &result[0]);
+        for (unsigned i = 0; i < length; ++i)   CPPUNIT_ASSERT_EQUAL(result[i], fp8.get(i));
+
+        AttributeFP16 fp16(length);
+        fp16.setRange(0, length, &values[0]);
+        fp16.getRange(0, length, &result[0]);
+        for (unsigned i = 0; i < length; ++i)   CPPUNIT_ASSERT_EQUAL(result[i], fp16.get(i));
+
+        AttributeVec3fFP16 vec3fp16(length);
+        vec3fp16.setRange(0, length, &vectors[0]);
+        vec3fp16.getRange(0, length, &vectorResult[0]);
+        for (unsigned i = 0; i < length; ++i)   CPPUNIT_ASSERT_EQUAL(vectorResult[i], vec3fp16.get(i));
+
+        AttributeFH truncate(length);
+        AttributeFH truncateScalar(length);
+        truncate.setRange(0, length, &values[0]);
+        for (unsigned i = 0; i < length; ++i)   truncateScalar.set(i, values[i]);
+        truncate.getRange(0, length, &result[0]);
+        for (unsigned i = 0; i < length; ++i) {
+            CPPUNIT_ASSERT_EQUAL(truncate.get(i), truncateScalar.get(i));
+            CPPUNIT_ASSERT_EQUAL(result[i], truncate.get(i));
+        }
+
+        AttributeVec3fH vec3Truncate(length);
+        vec3Truncate.setRange(0, length, &vectors[0]);
+        vec3Truncate.getRange(0, length, &vectorResult[0]);
+        for (unsigned i = 0; i < length; ++i) {
+            CPPUNIT_ASSERT_EQUAL(vectorResult[i], vec3Truncate.get(i));
+            CPPUNIT_ASSERT_EQUAL(vectorResult[i], Vec3f(Vec3<half>(vectors[i])));
+        }
+    }
+
+    // check codec dispatch resolves the concrete typed attribute array
+
+    {
+        typedef TypedAttributeArray<Vec3f, FixedPointCodec<true> >      AttributeVec3fFP8;
+        typedef TypedAttributeArray<Vec3f, UnitVecCodec>                AttributeVec3fUV;
+
+        AttributeVec3f vec3f(1);
+        vec3f.set(0, Vec3f(1, 2, 3));
+        AttributeVec3fFP8 vec3fp8(1);
+        vec3fp8.set(0, Vec3f(0.25f));
+        AttributeVec3fUV vec3uv(1);
+        vec3uv.set(0, Vec3f(0, 1, 0));
+        AttributeFH truncate(1);
+        truncate.set(0, 0.5f);
+        AttributeI integer(1);
+        integer.set(0, 5);
+
+        {
+            TypedArrayCodecOp<Vec3f> op;
+            CPPUNIT_ASSERT(dispatchTypedAttributeArray<Vec3f>(
+                static_cast<const AttributeArray&>(vec3f), op));
+            CPPUNIT_ASSERT_EQUAL(op.mCodec, std::string("null"));
+            CPPUNIT_ASSERT_EQUAL(op.mValue, Vec3f(1, 2, 3));
+        }
+
+        {
+            TypedArrayCodecOp<Vec3f> op;
+            CPPUNIT_ASSERT(dispatchTypedAttributeArray<Vec3f>(
+                static_cast<AttributeArray&>(vec3fp8), op));
+            CPPUNIT_ASSERT_EQUAL(op.mCodec, std::string("fxpt8"));
+            CPPUNIT_ASSERT_EQUAL(op.mValue, vec3fp8.get(0));
+        }
+
+        {
+            TypedArrayCodecOp<Vec3f> op;
+            CPPUNIT_ASSERT(dispatchTypedAttributeArray<Vec3f>(
+                static_cast<const AttributeArray&>(vec3uv), op));
+            CPPUNIT_ASSERT_EQUAL(op.mCodec, std::string("uvec"));
+            CPPUNIT_ASSERT_EQUAL(op.mValue, vec3uv.get(0));
+        }
+
+        {
+            TypedArrayCodecOp<float> op;
+            CPPUNIT_ASSERT(dispatchTypedAttributeArray<float>(
+                static_cast<const AttributeArray&>(truncate), op));
+            CPPUNIT_ASSERT_EQUAL(op.mCodec, std::string("trnc"));
+            CPPUNIT_ASSERT_EQUAL(op.mValue, 0.5f);
+        }
+
+        // value type mismatch does not invoke the op
+
+        {
+            TypedArrayCodecOp<float> op;
+            CPPUNIT_ASSERT(!dispatchTypedAttributeArray<float>(
+                static_cast<const AttributeArray&>(integer), op));
+            CPPUNIT_ASSERT_EQUAL(op.mCodec, std::string("none"));
+        }
+
+        // a custom codec list restricts the candidates
+
+        {
+            typedef boost::mpl::vector<NullCodec> CodecsT;
+
+            TypedArrayCodecOp<Vec3f> op;
+            CPPUNIT_ASSERT(!(dispatchTypedAttributeArray<Vec3f, CodecsT>(
+                static_cast<const AttributeArray&>(vec3fp8), op)));
+            CPPUNIT_ASSERT((dispatchTypedAttributeArray<Vec3f, CodecsT>(
+                static_cast<const AttributeArray&>(vec3f), op)));
+            CPPUNIT_ASSERT_EQUAL(op.mCodec, std::string("null"));
+        }
+    }
+
+    // check handle accessors are shared between arrays of the same type
+
+    {
+        AttributeI attr1(count);
+        AttributeI attr2(count);
+        AttributeFH attr3(count);
+
+        const AttributeArray& array1 = attr1;
+        const AttributeArray& array2 = attr2;
+        const AttributeArray& array3 = attr3;
+
+        CPPUNIT_ASSERT_EQUAL(&array1.getAccessor(), &array2.getAccessor());
+        CPPUNIT_ASSERT(static_cast<const AttributeArray::AccessorBase*>(&array1.getAccessor()) !=
+                       static_cast<const AttributeArray::AccessorBase*>(&array3.getAccessor()));
+
+        attr1.set(1, 5);
+        attr2.set(1, 6);
+
+        AttributeHandle<int> handle1(attr1);
+        AttributeHandle<int> handle2(attr2);
+
+        CPPUNIT_ASSERT(handle1.mGetter == handle2.mGetter);
+        CPPUNIT_ASSERT(!handle1.mLocalArray);
+        CPPUNIT_ASSERT_EQUAL(handle1.get(1), 5);
+        CPPUNIT_ASSERT_EQUAL(handle2.get(1), 6);
+    }
 }
 
 void
@@ -1138,10 +1612,10 @@ TestAttributeArray::testStrided()
         CPPUNIT_ASSERT_EQUAL(handle.stride(), Index(3));
         CPPUNIT_ASSERT_EQUAL(handle.size(), size_t(2));
 
-#ifdef OPENVDB_2_ABI_COMPATIBLE
-        size_t arrayMem = 48;
+        #ifdef OPENVDB_2_ABI_COMPATIBLE
+        size_t arrayMem = 104;
 #else
-        size_t arrayMem = 64;
+        size_t arrayMem = 144;
 #endif
 
         CPPUNIT_ASSERT_EQUAL(array->memUsage(), sizeof(int) * /*size*/3 * /*stride*/2 + arrayMem);
@@ -1199,10 +1673,10 @@ TestAttributeArray::testStrided()
         CPPUNIT_ASSERT_EQUAL(handle.get(0, 2), 5);
         CPPUNIT_ASSERT_EQUAL(handle.get(1, 1), 10);
 
-#ifdef OPENVDB_2_ABI_COMPATIBLE
-        size_t arrayMem = 48;
+        #ifdef OPENVDB_2_ABI_COMPATIBLE
+        size_t arrayMem = 104;
 #else
-        size_t arrayMem = 64;
+        size_t arrayMem = 144;
 #endif
 
         CPPUNIT_ASSERT_EQUAL(array->memUsage(), sizeof(int) * /*size*/3 * /*stride*/2 + arrayMem);
@@ -1573,6 +2047,44 @@ TestAttributeArray::testDelayedLoad()
             }
         }
 
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+        // read in using delayed load and check releasing and re-loading restores the
+        // in-memory compression of the data
+        {
+            AttributeArrayI attrB;
+
+            std::ifstream filein(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+            io::setMappedFilePtr(filein, mappedFile);
+
+            attrB.read(filein);
+            attrB.loadData();
+
+            const bool compressed = attrB.isCompressed();
+            const size_t memUsage = attrB.memUsage();
+
+            for (int release = 0; release < 2; release++) {
+                CPPUNIT_ASSERT(attrB.isReleasable());
+                CPPUNIT_ASSERT(attrB.releaseData());
+                CPPUNIT_ASSERT(attrB.isOutOfCore());
+                CPPUNIT_ASSERT_EQUAL(compressed, attrB.isCompressed());
+
+                attrB.loadData();
+
+                CPPUNIT_ASSERT(!attrB.isOutOfCore());
+                CPPUNIT_ASSERT_EQUAL(compressed, attrB.isCompressed());
+                CPPUNIT_ASSERT_EQUAL(memUsage, attrB.memUsage());
+
+                for (unsigned i = 0; i < unsigned(count); ++i) {
+                    CPPUNIT_ASSERT_EQUAL(attrA.get(i), attrB.get(i));
+                }
+
+                // the data is compressed again when released after an in-place decompression
+
+                attrB.decompress();
+            }
+        }
+#endif
+
         // read in using delayed load and check implicit load through get()
         {
             AttributeArrayI attrB;
@@ -1688,6 +2200,114 @@ TestAttributeArray::testDelayedLoad()
 
         std::remove(mappedFile->filename().c_str());
         std::remove(filename.c_str());
+
+        AttributeArrayI attrE(count);
+
+        for (unsigned i = 0; i < unsigned(count); ++i) {
+            attrE.set(i, int(i));
+        }
+
+        // write out uncompressed attribute array to a temp file, padded so that
+        // the array data is aligned for direct access from the mapped file
+
+        const openvdb::Int16 padding(0);
+
+        {
+            std::ofstream fileout;
+            filename = tempDir + "/openvdb_delayed5";
+            fileout.open(filename.c_str());
+
+            fileout.write(reinterpret_cast<const char*>(&padding), sizeof(openvdb::Int16));
+            attrE.write(fileout);
+
+            fileout.close();
+        }
+
+        // abuse File being a friend of MappedFile to get around the private constructor
+
+        proxy = new ProxyMappedFile(filename);
+        mappedFile.reset(reinterpret_cast<io::MappedFile*>(proxy));
+
+        AttributeArray::setMapUncompressedData(true);
+
+        // read in using delayed load and check data is mapped and copied on write
+        {
+            AttributeArrayI attrB;
+
+            std::ifstream filein(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+            io::setMappedFilePtr(filein, mappedFile);
+
+            openvdb::Int16 temp;
+            filein.read(reinterpret_cast<char*>(&temp), sizeof(openvdb::Int16));
+            attrB.read(filein);
+
+            CPPUNIT_ASSERT(!attrB.isMapped());
+
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+            CPPUNIT_ASSERT(attrB.isOutOfCore());
+            attrB.loadData();
+
+            CPPUNIT_ASSERT(!attrB.isOutOfCore());
+            CPPUNIT_ASSERT(attrB.isMapped());
+            CPPUNIT_ASSERT(attrB.memUsage() < attrE.memUsage());
+#endif
+
+            for (unsigned i = 0; i < unsigned(count); ++i) {
+                CPPUNIT_ASSERT_EQUAL(attrE.get(i), attrB.get(i));
+            }
+
+            // copies share the mapped data
+
+            AttributeArrayI attrC(attrB);
+
+            CPPUNIT_ASSERT_EQUAL(attrB.isMapped(), attrC.isMapped());
+
+            // writing copies the mapped data
+
+            attrB.set(0, 10);
+
+            CPPUNIT_ASSERT(!attrB.isMapped());
+            CPPUNIT_ASSERT_EQUAL(attrB.get(0), 10);
+            CPPUNIT_ASSERT_EQUAL(attrC.get(0), 0);
+
+            for (unsigned i = 1; i < unsigned(count); ++i) {
+                CPPUNIT_ASSERT_EQUAL(attrE.get(i), attrB.get(i));
+            }
+
+            {
+                AttributeWriteHandle<int> handle(attrC);
+
+                CPPUNIT_ASSERT(!attrC.isMapped());
+
+                handle.set(1, 20);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(attrC.get(1), 20);
+            CPPUNIT_ASSERT_EQUAL(attrB.get(1), 1);
+        }
+
+        AttributeArray::setMapUncompressedData(false);
+
+        // read in using delayed load and check data is not mapped by default
+        {
+            AttributeArrayI attrB;
+
+            std::ifstream filein(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+            io::setMappedFilePtr(filein, mappedFile);
+
+            openvdb::Int16 temp;
+            filein.read(reinterpret_cast<char*>(&temp), sizeof(openvdb::Int16));
+            attrB.read(filein);
+            attrB.loadData();
+
+            CPPUNIT_ASSERT(!attrB.isMapped());
+            CPPUNIT_ASSERT_EQUAL(attrE.memUsage(), attrB.memUsage());
+        }
+
+        // cleanup temp files
+
+        std::remove(mappedFile->filename().c_str());
+        std::remove(filename.c_str());
     }
 }
 
@@ -1771,6 +2391,446 @@ TestAttributeArray::testMatrices()
 }
 
 
+void
+TestAttributeArray::testDeltaPack()
+{
+    using namespace openvdb;
+
+    typedef TypedAttributeArray<int32_t, DeltaPackCodec>    AttributeDI;
+    typedef TypedAttributeArray<int64_t, DeltaPackCodec>    AttributeDL;
+
+    AttributeDI::registerType();
+    AttributeDL::registerType();
+
+    CPPUNIT_ASSERT(AttributeDI::isRegistered());
+    CPPUNIT_ASSERT(AttributeDI::attributeType().second == "dpck");
+    CPPUNIT_ASSERT(AttributeDI::attributeType().first == "int32");
+
+    const Index count = 1000;
+
+    { // sorted ids pack into a fraction of their uncompressed size
+        AttributeDI attr(count);
+
+        for (Index i = 0; i < count; i++)   attr.set(i, int32_t(5000 + i * 3));
+
+        const size_t uncompressedMemUsage = attr.memUsage();
+
+        CPPUNIT_ASSERT(attr.isCompressedReadable());
+        CPPUNIT_ASSERT(attr.compress());
+        CPPUNIT_ASSERT(attr.isCompressed());
+        CPPUNIT_ASSERT(attr.memUsage() < sizeof(AttributeDI) +
+            (uncompressedMemUsage - sizeof(AttributeDI)) / 4);
+
+        // values can be read while packed without decompressing
+
+        CPPUNIT_ASSERT_EQUAL(int32_t(5000), attr.get(0));
+        CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 63 * 3), attr.get(63));
+        CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 64 * 3), attr.get(64));
+        CPPUNIT_ASSERT_EQUAL(int32_t(5000 + (count - 1) * 3), attr.get(count - 1));
+
+        std::vector<int32_t> values(count);
+        attr.getRange(0, count, &values[0]);
+
+        for (Index i = 0; i < count; i++) {
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + i * 3), values[i]);
+        }
+
+        attr.getRange(100, 50, &values[0]);
+
+        for (Index i = 0; i < 50; i++) {
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + (100 + i) * 3), values[i]);
+        }
+
+        CPPUNIT_ASSERT(attr.isCompressed());
+
+        { // read-only handles access the packed data directly
+            AttributeHandle<int32_t> handle(attr);
+
+            CPPUNIT_ASSERT(attr.isCompressed());
+
+            for (Index i = 0; i < count; i++) {
+                CPPUNIT_ASSERT_EQUAL(int32_t(5000 + i * 3), handle.get(i));
+            }
+
+            // values are decoded a block at a time, including out of order and partial blocks
+
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 130 * 3), handle.get(130));
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 2 * 3), handle.get(2));
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + (count - 1) * 3), handle.get(count - 1));
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 129 * 3), handle.get(129));
+
+            // copies of a handle decode their own blocks
+
+            AttributeHandle<int32_t> handleCopy(handle);
+
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 700 * 3), handleCopy.get(700));
+            CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 129 * 3), handle.get(129));
+
+            AttributeHandle<int32_t, DeltaPackCodec> handleTyped(attr);
+
+            for (Index i = count; i > 0; i--) {
+                CPPUNIT_ASSERT_EQUAL(int32_t(5000 + (i - 1) * 3), handleTyped.get(i - 1));
+            }
+        }
+
+        // uncompressed copies unpack the values
+
+        AttributeArray::Ptr copy = attr.copyUncompressed();
+
+        CPPUNIT_ASSERT(!copy->isCompressed());
+        CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 500 * 3), AttributeDI::cast(*copy).get(500));
+
+        { // write handles decompress
+            AttributeWriteHandle<int32_t> handle(attr);
+
+            CPPUNIT_ASSERT(!attr.isCompressed());
+
+            handle.set(10, -7);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(int32_t(-7), attr.get(10));
+        CPPUNIT_ASSERT_EQUAL(int32_t(5000 + 11 * 3), attr.get(11));
+
+        // the packed data is retained when written and read back
+
+        CPPUNIT_ASSERT(attr.compress());
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attr.write(ostr);
+
+        AttributeDI attrB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT(attrB.isCompressed());
+        CPPUNIT_ASSERT_EQUAL(attr.memUsage(), attrB.memUsage());
+        CPPUNIT_ASSERT(attr == attrB);
+
+        CPPUNIT_ASSERT(attrB.decompress());
+
+        for (Index i = 0; i < count; i++) {
+            CPPUNIT_ASSERT_EQUAL(attr.get(i), attrB.get(i));
+        }
+    }
+
+    { // unsorted and extreme values
+        AttributeDL attr(count);
+
+        std::vector<int64_t> values(count);
+
+        for (Index i = 0; i < count; i++)   values[i] = int64_t((i * 7919) % 2001) - 1000;
+
+        values[10] = std::numeric_limits<int64_t>::min();
+        values[11] = std::numeric_limits<int64_t>::max();
+        values[12] = std::numeric_limits<int64_t>::min();
+
+        attr.setRange(0, count, &values[0]);
+
+        CPPUNIT_ASSERT(attr.compress());
+
+        for (Index i = 0; i < count; i++) {
+            CPPUNIT_ASSERT_EQUAL(values[i], attr.get(i));
+        }
+
+        // values that do not pack smaller are left uncompressed
+
+        AttributeDL noise(count);
+
+        for (Index i = 0; i < count; i++) {
+            uint64_t hash = uint64_t(i + 1) * 0x9E3779B97F4A7C15ULL;
+            hash = (hash ^ (hash >> 31)) * 0xBF58476D1CE4E5B9ULL;
+            noise.set(i, int64_t(hash ^ (hash >> 29)));
+        }
+
+        CPPUNIT_ASSERT(!noise.compress());
+        CPPUNIT_ASSERT(!noise.isCompressed());
+    }
+}
+
+
+void
+TestAttributeArray::testQuantizedPositions()
+{
+    using namespace openvdb;
+    using attribute_compression::Settings;
+
+    typedef TypedAttributeArray<Vec3f, QuantizedPositionCodec>  AttributeQ;
+
+    AttributeQ::registerType();
+
+    CPPUNIT_ASSERT(AttributeQ::isRegistered());
+    CPPUNIT_ASSERT(AttributeQ::attributeType().second == "qpos");
+
+    const Index count = 1000;
+
+    std::vector<Vec3f> positions(count);
+
+    for (Index i = 0; i < count; i++) {
+        positions[i] = Vec3f(   float((i * 37) % 101) / 100.0f - 0.5f,
+                                float((i * 53) % 97) / 400.0f,
+                                0.25f);
+    }
+
+    { // arrays are only quantized with a positive tolerance
+        AttributeQ attr(count);
+        attr.setRange(0, count, &positions[0]);
+
+        CPPUNIT_ASSERT(attr.isCompressedReadable());
+        CPPUNIT_ASSERT(!attr.compress());
+        CPPUNIT_ASSERT(!attr.isCompressed());
+
+        CPPUNIT_ASSERT_THROW(attr.setCompressionSettings(
+            Settings(Settings::LZ4, 9, Settings::SHUFFLE, 256, /*tolerance=*/-1.0f)), openvdb::ValueError);
+    }
+
+    std::vector<size_t> memUsage;
+
+    const float tolerances[] = { 1e-2f, 1e-3f, 1e-5f };
+
+    for (int t = 0; t < 3; t++) {
+        const float tolerance = tolerances[t];
+
+        AttributeQ attr(count);
+        attr.setRange(0, count, &positions[0]);
+        attr.setCompressionSettings(Settings(Settings::LZ4, 9, Settings::SHUFFLE, 256, tolerance));
+
+        const size_t uncompressedMemUsage = attr.memUsage();
+
+        CPPUNIT_ASSERT(attr.compress());
+        CPPUNIT_ASSERT(attr.isCompressed());
+        CPPUNIT_ASSERT(attr.memUsage() < uncompressedMemUsage);
+
+        memUsage.push_back(attr.memUsage());
+
+        // values can be read while quantized and are within the tolerance
+
+        std::vector<Vec3f> values(count);
+        attr.getRange(0, count, &values[0]);
+
+        CPPUNIT_ASSERT(attr.isCompressed());
+
+        for (Index i = 0; i < count; i++) {
+            CPPUNIT_ASSERT(std::abs(values[i].x() - positions[i].x()) <= tolerance);
+            CPPUNIT_ASSERT(std::abs(values[i].y() - positions[i].y()) <= tolerance);
+            CPPUNIT_ASSERT_EQUAL(positions[i].z(), values[i].z());
+            CPPUNIT_ASSERT_EQUAL(values[i], attr.get(i));
+        }
+
+        { // ranges decoded from an offset match individual values
+            std::vector<Vec3f> range(101);
+            attr.getRange(7, 101, &range[0]);
+
+            for (Index i = 0; i < 101; i++)   CPPUNIT_ASSERT_EQUAL(values[i + 7], range[i]);
+        }
+
+        // the quantized data is retained when written and read back
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attr.write(ostr);
+
+        AttributeQ attrB;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrB.read(istr);
+
+        CPPUNIT_ASSERT(attrB.isCompressed());
+        CPPUNIT_ASSERT(attr == attrB);
+
+        // decompressing restores the quantized values
+
+        CPPUNIT_ASSERT(attrB.decompress());
+        CPPUNIT_ASSERT(!attrB.isCompressed());
+
+        for (Index i = 0; i < count; i++)   CPPUNIT_ASSERT_EQUAL(values[i], attrB.get(i));
+    }
+
+    // finer tolerances use more bits
+
+    CPPUNIT_ASSERT(memUsage[0] < memUsage[1]);
+    CPPUNIT_ASSERT(memUsage[1] < memUsage[2]);
+
+    { // tolerances beyond the precision of the quantized values leave the array uncompressed
+        AttributeQ attr(count);
+        attr.setRange(0, count, &positions[0]);
+        attr.setCompressionSettings(Settings(Settings::LZ4, 9, Settings::SHUFFLE, 256, 1e-9f));
+
+        CPPUNIT_ASSERT(!attr.compress());
+    }
+}
+
+
+void
+TestAttributeArray::testSparse()
+{
+    using namespace openvdb;
+
+    typedef TypedAttributeArray<float>  AttributeArrayF;
+    typedef TypedAttributeArray<int>    AttributeArrayI;
+
+    const Index count = 1000;
+
+    { // mostly default values are stored sparsely
+        AttributeArrayF attr(count);
+        attr.expand();
+
+        attr.set(3, 1.5f);
+        attr.set(500, -2.0f);
+        attr.set(999, 7.0f);
+
+        const size_t expandedMemUsage = attr.memUsage();
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT(attr.isSparse());
+        CPPUNIT_ASSERT(!attr.isUniform());
+        CPPUNIT_ASSERT(attr.memUsage() < sizeof(AttributeArrayF) +
+            (expandedMemUsage - sizeof(AttributeArrayF)) / 10);
+
+        CPPUNIT_ASSERT_EQUAL(0.0f, attr.get(0));
+        CPPUNIT_ASSERT_EQUAL(1.5f, attr.get(3));
+        CPPUNIT_ASSERT_EQUAL(-2.0f, attr.get(500));
+        CPPUNIT_ASSERT_EQUAL(7.0f, attr.get(999));
+
+        std::vector<float> values(10);
+        attr.getRange(495, 10, &values[0]);
+
+        for (Index i = 0; i < 10; i++) {
+            CPPUNIT_ASSERT_EQUAL(i == 5 ? -2.0f : 0.0f, values[i]);
+        }
+
+        // sparse arrays are not compacted further, or compressed unless this is smaller
+
+        CPPUNIT_ASSERT(!attr.compress());
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT(attr.isSparse());
+
+        { // read-only handles access the sparse values directly
+            AttributeHandle<float> handle(attr);
+
+            CPPUNIT_ASSERT_EQUAL(1.5f, handle.get(3));
+            CPPUNIT_ASSERT_EQUAL(0.0f, handle.get(4));
+            CPPUNIT_ASSERT(attr.isSparse());
+        }
+
+        // copies retain the sparse values
+
+        AttributeArrayF attrB(attr);
+
+        CPPUNIT_ASSERT(attrB.isSparse());
+        CPPUNIT_ASSERT(attr == attrB);
+
+        AttributeArrayF attrC(count);
+        attrC = attr;
+
+        CPPUNIT_ASSERT(attrC.isSparse());
+        CPPUNIT_ASSERT(attr == attrC);
+
+        // sparse arrays are written expanded
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attr.write(ostr);
+
+        AttributeArrayF attrD;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrD.read(istr);
+
+        CPPUNIT_ASSERT(!attrD.isSparse());
+        CPPUNIT_ASSERT(!attrD.compact());
+        CPPUNIT_ASSERT(attr == attrD);
+
+        // setting a value expands the array
+
+        attrB.set(4, 3.0f);
+
+        CPPUNIT_ASSERT(!attrB.isSparse());
+        CPPUNIT_ASSERT_EQUAL(1.5f, attrB.get(3));
+        CPPUNIT_ASSERT_EQUAL(3.0f, attrB.get(4));
+        CPPUNIT_ASSERT_EQUAL(7.0f, attrB.get(999));
+
+        { // write handles expand sparse arrays even if expansion is not requested
+            AttributeWriteHandle<float> handle(attrC, /*expand=*/false);
+
+            CPPUNIT_ASSERT(!attrC.isSparse());
+            handle.set(5, 4.0f);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(-2.0f, attrC.get(500));
+        CPPUNIT_ASSERT_EQUAL(4.0f, attrC.get(5));
+
+        // filling or collapsing releases the sparse values
+
+        attr.fill(2.0f);
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(!attr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(2.0f, attr.get(3));
+        CPPUNIT_ASSERT_EQUAL(2.0f, attr.get(998));
+
+        CPPUNIT_ASSERT(attr.compact());
+        CPPUNIT_ASSERT(attr.isUniform());
+    }
+
+    { // sparse arrays are compressed if the compressed data is smaller than the sparse storage
+        AttributeArrayI attr(count);
+        attr.expand();
+
+        for (Index i = 0; i < count; i += 5)    attr.set(i, 7);
+
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT(attr.isSparse());
+
+#ifdef OPENVDB_USE_BLOSC
+        const size_t sparseMemUsage = attr.memUsage();
+
+        CPPUNIT_ASSERT(attr.compress());
+        CPPUNIT_ASSERT(attr.isCompressed());
+        CPPUNIT_ASSERT(!attr.isSparse());
+        CPPUNIT_ASSERT(attr.memUsage() < sparseMemUsage);
+
+        AttributeHandle<int> handle(attr);
+
+        for (Index i = 0; i < count; i++) {
+            CPPUNIT_ASSERT_EQUAL(i % 5 == 0 ? 7 : 0, handle.get(i));
+        }
+#endif
+    }
+
+    { // the most common value is the default value
+        AttributeArrayI attr(count, /*stride=*/2);
+        attr.expand();
+
+        for (Index i = 0; i < count * 2; i++)   attr.set(i, i % 100 == 0 ? int(i) : 5);
+
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT(attr.isSparse());
+
+        for (Index i = 0; i < count * 2; i++) {
+            CPPUNIT_ASSERT_EQUAL(i % 100 == 0 ? int(i) : 5, attr.get(i));
+        }
+
+        attr.expand();
+
+        CPPUNIT_ASSERT(!attr.isSparse());
+
+        for (Index i = 0; i < count * 2; i++) {
+            CPPUNIT_ASSERT_EQUAL(i % 100 == 0 ? int(i) : 5, attr.get(i));
+        }
+    }
+
+    { // arrays without a sufficiently common value remain expanded
+        AttributeArrayI attr(count);
+        attr.expand();
+
+        for (Index i = 0; i < count; i++)   attr.set(i, i % 3 == 0 ? 0 : int(i));
+
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT(!attr.isSparse());
+    }
+}
+
+
 namespace profile {
 
 typedef openvdb::util::ProfileTimer ProfileTimer;
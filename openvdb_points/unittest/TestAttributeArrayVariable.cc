@@ -0,0 +1,441 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+//
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
+//
+// Redistributions of source code must retain the above copyright
+// and license notice and the following restrictions and disclaimer.
+//
+// *     Neither the name of Double Negative Visual Effects nor the names
+// of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDERS' AND CONTRIBUTORS' AGGREGATE
+// LIABILITY FOR ALL CLAIMS REGARDLESS OF THEIR BASIS EXCEED US$250.00.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <openvdb_points/tools/AttributeArrayVariable.h>
+#include <openvdb_points/tools/AttributeSet.h>
+
+#include <openvdb_points/openvdb.h>
+#include <openvdb/openvdb.h>
+
+#include <sstream>
+#include <vector>
+
+using namespace openvdb;
+using namespace openvdb::tools;
+
+class TestAttributeArrayVariable: public CppUnit::TestCase
+{
+public:
+    virtual void setUp() { openvdb::initialize(); openvdb::points::initialize(); }
+    virtual void tearDown() { openvdb::uninitialize(); openvdb::points::uninitialize(); }
+
+    CPPUNIT_TEST_SUITE(TestAttributeArrayVariable);
+    CPPUNIT_TEST(testVariableAttribute);
+    CPPUNIT_TEST(testVariableAttributeCompaction);
+    CPPUNIT_TEST(testVariableAttributeIO);
+    CPPUNIT_TEST(testVariableAttributeHandle);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    void testVariableAttribute();
+    void testVariableAttributeCompaction();
+    void testVariableAttributeIO();
+    void testVariableAttributeHandle();
+
+}; // class TestAttributeArrayVariable
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestAttributeArrayVariable);
+
+
+////////////////////////////////////////
+
+
+namespace {
+
+typedef VariableAttributeArray<int32_t>    AttributeArrayI;
+typedef VariableAttributeArray<float>      AttributeArrayF;
+
+// populate each point n with n % 4 values of n * 10 + m
+void
+populate(AttributeArrayI& array)
+{
+    std::vector<int32_t> values;
+    for (Index n = 0; n < Index(array.size()); n++) {
+        values.clear();
+        for (Index m = 0; m < n % 4; m++)   values.push_back(int32_t(n * 10 + m));
+        array.set(n, values);
+    }
+}
+
+} // namespace
+
+
+////////////////////////////////////////
+
+
+void
+TestAttributeArrayVariable::testVariableAttribute()
+{
+    { // type and registration
+        CPPUNIT_ASSERT(AttributeArrayI::isRegistered());
+        CPPUNIT_ASSERT(AttributeArrayF::isRegistered());
+
+        CPPUNIT_ASSERT_EQUAL(AttributeArrayI::attributeType().first, Name("int32[]"));
+        CPPUNIT_ASSERT_EQUAL(AttributeArrayI::attributeType().second, Name("null"));
+
+        AttributeArray::Ptr array = AttributeArray::create(AttributeArrayI::attributeType(), 10);
+        CPPUNIT_ASSERT(array->isType<AttributeArrayI>());
+        CPPUNIT_ASSERT(!array->hasValueType<int32_t>());
+        CPPUNIT_ASSERT(array->isUniform());
+        CPPUNIT_ASSERT_EQUAL(array->size(), size_t(10));
+        CPPUNIT_ASSERT_EQUAL(array->stride(), Index(1));
+
+        // fixed-stride handles cannot be bound to variable arrays
+
+        CPPUNIT_ASSERT_THROW(AttributeHandle<int32_t>::create(*array), openvdb::TypeError);
+    }
+
+    { // set and get values
+        AttributeArrayI array(20);
+
+        CPPUNIT_ASSERT_EQUAL(array.count(5), Index(0));
+
+        populate(array);
+
+        CPPUNIT_ASSERT(!array.isUniform());
+        CPPUNIT_ASSERT_EQUAL(array.valueCount(), Index(5 * (0 + 1 + 2 + 3)));
+
+        for (Index n = 0; n < 20; n++) {
+            CPPUNIT_ASSERT_EQUAL(array.count(n), n % 4);
+            for (Index m = 0; m < n % 4; m++) {
+                CPPUNIT_ASSERT_EQUAL(array.get(n, m), int32_t(n * 10 + m));
+            }
+        }
+
+        CPPUNIT_ASSERT_THROW(array.get(4, 0), openvdb::IndexError);
+        CPPUNIT_ASSERT_THROW(array.get(20, 0), openvdb::IndexError);
+        CPPUNIT_ASSERT_THROW(array.set(4, 0, 1), openvdb::IndexError);
+
+        array.set(3, 1, 100);
+        CPPUNIT_ASSERT_EQUAL(array.get(3, 1), 100);
+
+        // resize the values of a point followed by other points with values
+
+        std::vector<int32_t> values(5, 7);
+        array.set(2, values);
+
+        CPPUNIT_ASSERT_EQUAL(array.count(2), Index(5));
+        CPPUNIT_ASSERT_EQUAL(array.valueCount(), Index(30 + 3));
+        CPPUNIT_ASSERT_EQUAL(array.get(2, 4), 7);
+        CPPUNIT_ASSERT_EQUAL(array.get(3, 1), 100);
+        CPPUNIT_ASSERT_EQUAL(array.get(19, 2), 192);
+
+        array.set(2, std::vector<int32_t>());
+
+        CPPUNIT_ASSERT_EQUAL(array.count(2), Index(0));
+        CPPUNIT_ASSERT_EQUAL(array.get(3, 2), 32);
+
+        std::vector<int32_t> result;
+        array.get(3, result);
+        CPPUNIT_ASSERT_EQUAL(result.size(), size_t(3));
+        CPPUNIT_ASSERT_EQUAL(result[1], 100);
+    }
+
+    { // set counts
+        AttributeArrayI array(4);
+        populate(array);
+
+        std::vector<Index> counts;
+        counts.push_back(2);
+        counts.push_back(0);
+        counts.push_back(3);
+        counts.push_back(3);
+
+        array.setCounts(counts);
+
+        CPPUNIT_ASSERT_EQUAL(array.valueCount(), Index(8));
+        CPPUNIT_ASSERT_EQUAL(array.get(0, 1), 0);
+        CPPUNIT_ASSERT_EQUAL(array.count(1), Index(0));
+        CPPUNIT_ASSERT_EQUAL(array.get(2, 1), 21);
+        CPPUNIT_ASSERT_EQUAL(array.get(2, 2), 0);
+        CPPUNIT_ASSERT_EQUAL(array.get(3, 2), 32);
+
+        counts.pop_back();
+        CPPUNIT_ASSERT_THROW(array.setCounts(counts), openvdb::ValueError);
+    }
+
+    { // set from another array, copy and equality
+        AttributeArrayI source(20);
+        populate(source);
+
+        AttributeArray::Ptr target = AttributeArray::create(AttributeArrayI::attributeType(), 20);
+
+        for (Index n = 0; n < 20; n++)     target->set(n, source, 19 - n);
+
+        AttributeArrayI& targetI = AttributeArrayI::cast(*target);
+
+        CPPUNIT_ASSERT_EQUAL(targetI.valueCount(), source.valueCount());
+        for (Index n = 0; n < 20; n++) {
+            CPPUNIT_ASSERT_EQUAL(targetI.count(n), source.count(19 - n));
+            for (Index m = 0; m < targetI.count(n); m++) {
+                CPPUNIT_ASSERT_EQUAL(targetI.get(n, m), source.get(19 - n, m));
+            }
+        }
+
+        CPPUNIT_ASSERT(*target != source);
+
+        AttributeArray::Ptr copy = source.copy();
+        CPPUNIT_ASSERT(*copy == source);
+
+        AttributeArrayF floats(20);
+        CPPUNIT_ASSERT_THROW(target->set(0, floats, 0), openvdb::TypeError);
+    }
+
+    { // collapse
+        AttributeArrayI array(20);
+        populate(array);
+
+        array.collapse();
+
+        CPPUNIT_ASSERT(array.isUniform());
+        CPPUNIT_ASSERT_EQUAL(array.valueCount(), Index(0));
+        CPPUNIT_ASSERT_EQUAL(array.count(3), Index(0));
+    }
+}
+
+
+void
+TestAttributeArrayVariable::testVariableAttributeCompaction()
+{
+    { // memory is proportional to the number of values
+        AttributeArrayI sparse(1000);
+        AttributeArrayI dense(1000);
+
+        std::vector<int32_t> values(100, 1);
+
+        sparse.set(10, values);
+        for (Index n = 0; n < 1000; n++)   dense.set(n, values);
+
+        sparse.compact();
+        dense.compact();
+
+        CPPUNIT_ASSERT(sparse.memUsage() < size_t(200 * sizeof(int32_t)) + sizeof(AttributeArrayI));
+        CPPUNIT_ASSERT(dense.memUsage() >= size_t(100000 * sizeof(int32_t)));
+
+        // points after the last with values store no offsets
+
+        CPPUNIT_ASSERT_EQUAL(sparse.count(11), Index(0));
+        CPPUNIT_ASSERT_EQUAL(sparse.count(999), Index(0));
+        CPPUNIT_ASSERT_EQUAL(sparse.get(10, 99), 1);
+
+        sparse.set(999, values);
+        CPPUNIT_ASSERT_EQUAL(sparse.valueCount(), Index(200));
+        CPPUNIT_ASSERT_EQUAL(sparse.get(999, 0), 1);
+    }
+
+    { // an array without values becomes uniform
+        AttributeArrayI array(10);
+        std::vector<int32_t> values(3, 1);
+        array.set(5, values);
+        array.set(5, std::vector<int32_t>());
+
+        CPPUNIT_ASSERT(array.isUniform());
+        CPPUNIT_ASSERT(array.compact());
+        CPPUNIT_ASSERT_EQUAL(array.memUsage(), sizeof(AttributeArrayI));
+    }
+
+#ifdef OPENVDB_USE_BLOSC
+    { // compression
+        AttributeArrayI array(100);
+        populate(array);
+
+        AttributeArrayI reference(array);
+
+        CPPUNIT_ASSERT(array.compress());
+        CPPUNIT_ASSERT(array.isCompressed());
+        CPPUNIT_ASSERT(!array.isUniform());
+        CPPUNIT_ASSERT_EQUAL(array.valueCount(), reference.valueCount());
+
+        AttributeArray::Ptr uncompressed = array.copyUncompressed();
+        CPPUNIT_ASSERT(!uncompressed->isCompressed());
+        CPPUNIT_ASSERT(array.isCompressed());
+
+        // access decompresses
+
+        CPPUNIT_ASSERT_EQUAL(array.get(99, 2), 992);
+        CPPUNIT_ASSERT(!array.isCompressed());
+
+        CPPUNIT_ASSERT(array == reference);
+        CPPUNIT_ASSERT(*uncompressed == reference);
+    }
+#endif
+}
+
+
+void
+TestAttributeArrayVariable::testVariableAttributeIO()
+{
+    AttributeArrayI reference(100);
+    populate(reference);
+
+    { // uncompressed, uniform and transient
+        AttributeArrayI uniform(20);
+
+        std::ostringstream ostr(std::ios_base::binary);
+        reference.write(ostr);
+        uniform.write(ostr);
+
+        AttributeArrayI array, uniformArray;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        array.read(istr);
+        uniformArray.read(istr);
+
+        CPPUNIT_ASSERT(array == reference);
+        CPPUNIT_ASSERT(uniformArray == uniform);
+        CPPUNIT_ASSERT(uniformArray.isUniform());
+
+        AttributeArrayI transient(reference);
+        transient.setTransient(true);
+
+        std::ostringstream ostr2(std::ios_base::binary);
+        transient.write(ostr2);
+        CPPUNIT_ASSERT(ostr2.str().empty());
+    }
+
+#ifdef OPENVDB_USE_BLOSC
+    { // compressed on-disk
+        std::ostringstream ostr(std::ios_base::binary);
+        io::setDataCompression(ostr, io::COMPRESS_BLOSC);
+        reference.write(ostr);
+
+        AttributeArrayI array;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        array.read(istr);
+
+        CPPUNIT_ASSERT(!array.isCompressed());
+        CPPUNIT_ASSERT(array == reference);
+    }
+
+    { // compressed in-memory
+        AttributeArrayI compressed(reference);
+        compressed.compress();
+
+        std::ostringstream ostr(std::ios_base::binary);
+        compressed.write(ostr);
+
+        AttributeArrayI array;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        array.read(istr);
+
+        CPPUNIT_ASSERT(array.isCompressed());
+        CPPUNIT_ASSERT(array == compressed);
+
+        array.decompress();
+        CPPUNIT_ASSERT(array == reference);
+    }
+#endif
+
+    { // attribute set
+        typedef AttributeSet::Descriptor Descriptor;
+
+        Descriptor::Ptr descr = Descriptor::create(TypedAttributeArray<Vec3f>::attributeType());
+        AttributeSet attrSet(descr, /*arrayLength=*/100);
+        attrSet.appendAttribute("ids", AttributeArrayI::attributeType());
+
+        AttributeArrayI& array = AttributeArrayI::cast(*attrSet.get("ids"));
+        populate(array);
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attrSet.write(ostr);
+
+        AttributeSet attrSet2;
+
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrSet2.read(istr);
+
+        CPPUNIT_ASSERT(*attrSet2.getConst("ids") == reference);
+    }
+}
+
+
+void
+TestAttributeArrayVariable::testVariableAttributeHandle()
+{
+    AttributeArrayI array(20);
+
+    { // write handle
+        VariableAttributeWriteHandle<int32_t> handle(array);
+
+        std::vector<int32_t> values(2, 3);
+        handle.set(4, values);
+        handle.set(4, 1, 5);
+
+        CPPUNIT_ASSERT_EQUAL(handle.size(), size_t(20));
+        CPPUNIT_ASSERT_EQUAL(handle.count(4), Index(2));
+        CPPUNIT_ASSERT_EQUAL(handle.get(4, 0), 3);
+        CPPUNIT_ASSERT_EQUAL(handle.get(4, 1), 5);
+        CPPUNIT_ASSERT(!handle.compact());
+    }
+
+    { // read handle
+        VariableAttributeHandle<int32_t>::Ptr handle = VariableAttributeHandle<int32_t>::create(array);
+
+        CPPUNIT_ASSERT(!handle->isUniform());
+        CPPUNIT_ASSERT_EQUAL(handle->get(4, 1), 5);
+
+        std::vector<int32_t> values;
+        handle->get(4, values);
+        CPPUNIT_ASSERT_EQUAL(values.size(), size_t(2));
+
+        // handles must match the value type
+
+        CPPUNIT_ASSERT_THROW(VariableAttributeHandle<float>::create(array), openvdb::TypeError);
+    }
+
+#ifdef OPENVDB_USE_BLOSC
+    { // read handles preserve compression
+        AttributeArrayI array(100);
+        populate(array);
+
+        CPPUNIT_ASSERT(array.compress());
+
+        VariableAttributeHandle<int32_t> handle(array);
+
+        CPPUNIT_ASSERT_EQUAL(handle.get(99, 2), 992);
+        CPPUNIT_ASSERT(array.isCompressed());
+
+        VariableAttributeWriteHandle<int32_t> writeHandle(array);
+
+        CPPUNIT_ASSERT(!array.isCompressed());
+        writeHandle.collapse();
+        CPPUNIT_ASSERT(array.isUniform());
+    }
+#endif
+}
+
+
+// Copyright (c) 2015-2016 Double Negative Visual Effects
+// All rights reserved. This software is distributed under the
+// Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
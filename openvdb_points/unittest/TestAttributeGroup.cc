@@ -53,12 +53,16 @@ public:
     CPPUNIT_TEST_SUITE(TestAttributeGroup);
     CPPUNIT_TEST(testAttributeGroup);
     CPPUNIT_TEST(testAttributeGroupHandle);
+    CPPUNIT_TEST(testAttributeGroupWords);
+    CPPUNIT_TEST(testAttributeGroupMembership);
     CPPUNIT_TEST(testAttributeGroupFilter);
 
     CPPUNIT_TEST_SUITE_END();
 
     void testAttributeGroup();
     void testAttributeGroupHandle();
+    void testAttributeGroupWords();
+    void testAttributeGroupMembership();
     void testAttributeGroupFilter();
 }; // class TestAttributeGroup
 
@@ -283,12 +287,16 @@ TestAttributeGroup::testAttributeGroupHandle()
 
     CPPUNIT_ASSERT_EQUAL(writeHandle3.get(1), true);
     CPPUNIT_ASSERT_EQUAL(writeHandle6.get(1), false);
+    CPPUNIT_ASSERT_EQUAL(writeHandle3.memberCount(), Index64(attr.size()));
 
     writeHandle6.set(2, true);
 
     CPPUNIT_ASSERT(!writeHandle3.collapse(false));
 
     CPPUNIT_ASSERT(!writeHandle3.isUniform());
+    CPPUNIT_ASSERT_EQUAL(writeHandle3.memberCount(), Index64(0));
+    CPPUNIT_ASSERT_EQUAL(writeHandle6.memberCount(), Index64(1));
+    CPPUNIT_ASSERT_EQUAL(writeHandle6.get(2), true);
 
     attr.fill(0);
 
@@ -394,6 +402,259 @@ private:
 }; // struct HandleWrapper
 
 
+void
+TestAttributeGroup::testAttributeGroupWords()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const Index size = 150;
+
+    GroupAttributeArray attr(size);
+
+    { // uniform arrays
+        GroupHandle handle(attr, 2);
+
+        CPPUNIT_ASSERT_EQUAL(handle.wordCount(), Index(3));
+        CPPUNIT_ASSERT_EQUAL(handle.getWord(0), Index64(0));
+        CPPUNIT_ASSERT_EQUAL(handle.getWord(2), Index64(0));
+        CPPUNIT_ASSERT_EQUAL(handle.memberCount(), Index64(0));
+
+        attr.collapse(GroupType(1) << 2);
+
+        CPPUNIT_ASSERT_EQUAL(handle.getWord(0), ~Index64(0));
+        CPPUNIT_ASSERT_EQUAL(handle.getWord(1), ~Index64(0));
+        CPPUNIT_ASSERT_EQUAL(handle.getWord(2), (Index64(1) << 22) - 1);
+        CPPUNIT_ASSERT_EQUAL(handle.getWord(3), Index64(0));
+        CPPUNIT_ASSERT_EQUAL(handle.memberCount(), Index64(size));
+    }
+
+    attr.expand();
+    attr.fill(0);
+
+    // groups 2 and 5 with different membership patterns
+
+    for (Index i = 0; i < size; i++) {
+        GroupType value(0);
+        if (i % 3 == 0)     value |= GroupType(1) << 2;
+        if (i % 7 == 1)     value |= GroupType(1) << 5;
+        attr.set(i, value);
+    }
+
+    { // words match per-index membership
+        GroupHandle handle2(attr, 2);
+        GroupHandle handle5(attr, 5);
+
+        Index64 count2(0), count5(0);
+
+        for (Index word = 0; word < handle2.wordCount(); word++) {
+            const Index64 bits2 = handle2.getWord(word);
+            const Index64 bits5 = handle5.getWord(word);
+
+            for (Index bit = 0; bit < 64; bit++) {
+                const Index n = word * 64 + bit;
+                const bool on2 = n < size && handle2.get(n);
+                const bool on5 = n < size && handle5.get(n);
+                CPPUNIT_ASSERT_EQUAL(on2, bool((bits2 >> bit) & 1));
+                CPPUNIT_ASSERT_EQUAL(on5, bool((bits5 >> bit) & 1));
+                if (on2)    count2++;
+                if (on5)    count5++;
+            }
+        }
+
+        CPPUNIT_ASSERT_EQUAL(handle2.memberCount(), count2);
+        CPPUNIT_ASSERT_EQUAL(handle5.memberCount(), count5);
+        CPPUNIT_ASSERT_EQUAL(count2, Index64(50));
+        CPPUNIT_ASSERT_EQUAL(count5, Index64(22));
+
+        CPPUNIT_ASSERT_THROW(handle2.get(size), IndexError);
+    }
+
+    { // setting words only changes the target group
+        GroupWriteHandle writeHandle2(attr, 2);
+        GroupHandle handle5(attr, 5);
+
+        const Index64 pattern(0xF0F0F0F0F0F0F0F0UL);
+
+        for (Index word = 0; word < writeHandle2.wordCount(); word++) {
+            writeHandle2.setWord(word, pattern);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(writeHandle2.getWord(0), pattern);
+        CPPUNIT_ASSERT_EQUAL(writeHandle2.getWord(1), pattern);
+        CPPUNIT_ASSERT_EQUAL(writeHandle2.getWord(2), pattern & ((Index64(1) << 22) - 1));
+
+        for (Index i = 0; i < size; i++) {
+            CPPUNIT_ASSERT_EQUAL(writeHandle2.get(i), bool((i % 8) >= 4));
+            CPPUNIT_ASSERT_EQUAL(handle5.get(i), i % 7 == 1);
+        }
+
+        CPPUNIT_ASSERT_THROW(writeHandle2.setWord(3, pattern), IndexError);
+    }
+
+    { // setting an unchanged word leaves a uniform array uniform
+        GroupAttributeArray uniformAttr(size);
+        GroupWriteHandle writeHandle(uniformAttr, 1);
+
+        writeHandle.setWord(1, Index64(0));
+        CPPUNIT_ASSERT(uniformAttr.isUniform());
+
+        writeHandle.setWord(2, ~(Index64(1) << 3) << 22);
+        CPPUNIT_ASSERT(uniformAttr.isUniform());
+
+        writeHandle.setWord(2, Index64(1) << 3);
+        CPPUNIT_ASSERT(!uniformAttr.isUniform());
+        CPPUNIT_ASSERT_EQUAL(writeHandle.memberCount(), Index64(1));
+        CPPUNIT_ASSERT(writeHandle.get(64 * 2 + 3));
+    }
+
+#ifdef OPENVDB_USE_BLOSC
+    { // read-only handles read an uncompressed copy, leaving the array compressed
+        attr.compress();
+
+        CPPUNIT_ASSERT(attr.isCompressed());
+
+        GroupHandle handle5(attr, 5);
+
+        CPPUNIT_ASSERT(attr.isCompressed());
+        CPPUNIT_ASSERT_EQUAL(handle5.memberCount(), Index64(22));
+
+        // copies of a handle share its uncompressed copy
+
+        GroupHandle handleCopy(handle5);
+
+        CPPUNIT_ASSERT_EQUAL(handleCopy.memberCount(), Index64(22));
+
+        // unless compression is not preserved, which decompresses the array
+
+        GroupHandle handle5B(attr, 5, /*preserveCompression=*/false);
+
+        CPPUNIT_ASSERT(!attr.isCompressed());
+        CPPUNIT_ASSERT_EQUAL(handle5B.memberCount(), Index64(22));
+
+        // write handles decompress the array
+
+        attr.compress();
+
+        CPPUNIT_ASSERT(attr.isCompressed());
+
+        GroupWriteHandle writeHandle5(attr, 5);
+
+        CPPUNIT_ASSERT(!attr.isCompressed());
+        CPPUNIT_ASSERT_EQUAL(writeHandle5.memberCount(), Index64(22));
+    }
+#endif
+}
+
+
+void
+TestAttributeGroup::testAttributeGroupMembership()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    const Index size = 100;
+
+    GroupAttributeArray attr(size);
+
+    GroupType anyBits, allBits;
+
+    { // uniform array
+        attr.bitSummary(anyBits, allBits);
+
+        CPPUNIT_ASSERT_EQUAL(anyBits, GroupType(0));
+        CPPUNIT_ASSERT_EQUAL(allBits, GroupType(0));
+
+        GroupHandle handle(attr, 1);
+
+        CPPUNIT_ASSERT_EQUAL(handle.membership(), GroupHandle::NO_MEMBERS);
+
+        attr.collapse(GroupType(1) << 1);
+
+        CPPUNIT_ASSERT_EQUAL(handle.membership(), GroupHandle::ALL_MEMBERS);
+        CPPUNIT_ASSERT_EQUAL(handle.memberCount(), Index64(size));
+    }
+
+    { // writes through a handle invalidate the summary
+        GroupWriteHandle writeHandle1(attr, 1);
+        GroupWriteHandle writeHandle4(attr, 4);
+
+        writeHandle1.set(10, false);
+
+        CPPUNIT_ASSERT_EQUAL(writeHandle1.membership(), GroupHandle::SOME_MEMBERS);
+        CPPUNIT_ASSERT_EQUAL(writeHandle4.membership(), GroupHandle::NO_MEMBERS);
+
+        writeHandle4.set(20, true);
+
+        attr.bitSummary(anyBits, allBits);
+
+        CPPUNIT_ASSERT_EQUAL(anyBits, GroupType((1 << 1) | (1 << 4)));
+        CPPUNIT_ASSERT_EQUAL(allBits, GroupType(0));
+
+        CPPUNIT_ASSERT_EQUAL(writeHandle4.membership(), GroupHandle::SOME_MEMBERS);
+        CPPUNIT_ASSERT_EQUAL(writeHandle4.memberCount(), Index64(1));
+
+        writeHandle4.setWord(0, Index64(0));
+
+        CPPUNIT_ASSERT_EQUAL(writeHandle4.membership(), GroupHandle::NO_MEMBERS);
+
+        writeHandle1.set(10, true);
+
+        CPPUNIT_ASSERT_EQUAL(writeHandle1.membership(), GroupHandle::ALL_MEMBERS);
+
+        // compaction keeps the summary
+
+        CPPUNIT_ASSERT(writeHandle1.compact());
+        CPPUNIT_ASSERT_EQUAL(writeHandle1.membership(), GroupHandle::ALL_MEMBERS);
+    }
+
+    { // sparse arrays
+        attr.expand();
+        attr.set(50, GroupType(1) << 6);
+
+        CPPUNIT_ASSERT(!attr.compact());
+        CPPUNIT_ASSERT(attr.isSparse());
+
+        CPPUNIT_ASSERT_EQUAL(GroupHandle(attr, 1).membership(), GroupHandle::SOME_MEMBERS);
+        CPPUNIT_ASSERT_EQUAL(GroupHandle(attr, 6).membership(), GroupHandle::SOME_MEMBERS);
+        CPPUNIT_ASSERT_EQUAL(GroupHandle(attr, 7).membership(), GroupHandle::NO_MEMBERS);
+    }
+
+    { // bitmasks of several groups
+        attr.fill(GroupType(1) << 2);
+        attr.set(30, GroupType(1) << 3);
+
+        const GroupType bitmask23 = GroupType(1) << 2 | GroupType(1) << 3;
+
+        GroupHandle handle23(attr, bitmask23, GroupHandle::BitMask());
+
+        CPPUNIT_ASSERT_EQUAL(handle23.membership(), GroupHandle::NO_MEMBERS);
+
+        attr.set(40, bitmask23);
+
+        CPPUNIT_ASSERT_EQUAL(handle23.membership(), GroupHandle::SOME_MEMBERS);
+        CPPUNIT_ASSERT_EQUAL(handle23.memberCount(), Index64(1));
+    }
+
+    { // copies retain the summary
+        attr.bitSummary(anyBits, allBits);
+
+        GroupAttributeArray attrB(attr);
+
+        GroupType anyBitsB, allBitsB;
+        attrB.bitSummary(anyBitsB, allBitsB);
+
+        CPPUNIT_ASSERT_EQUAL(anyBitsB, anyBits);
+        CPPUNIT_ASSERT_EQUAL(allBitsB, allBits);
+
+        attrB.set(0, GroupType(1) << 7);
+        attrB.bitSummary(anyBitsB, allBitsB);
+
+        CPPUNIT_ASSERT_EQUAL(anyBitsB, GroupType(anyBits | (GroupType(1) << 7)));
+    }
+}
+
+
 void
 TestAttributeGroup::testAttributeGroupFilter()
 {
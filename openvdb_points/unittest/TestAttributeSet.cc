@@ -864,6 +864,129 @@ TestAttributeSet::testAttributeSet()
         CPPUNIT_ASSERT(matchingAttributeSets(attrSetA, attrSetB));
     }
 
+    { // I/O descriptor sharing test
+        std::ostringstream ostr(std::ios_base::binary);
+        attrSetA.write(ostr);
+        attrSetA.write(ostr);
+
+        AttributeSet attrSetB, attrSetC;
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrSetB.read(istr);
+        attrSetC.read(istr);
+
+        CPPUNIT_ASSERT(matchingAttributeSets(attrSetA, attrSetC));
+
+        // identical descriptors read from the same stream are shared
+
+        CPPUNIT_ASSERT_EQUAL(attrSetB.descriptorPtr(), attrSetC.descriptorPtr());
+
+        // descriptors read from a different stream are not shared
+
+        AttributeSet attrSetD;
+        std::istringstream istr2(ostr.str(), std::ios_base::binary);
+        attrSetD.read(istr2);
+
+        CPPUNIT_ASSERT(attrSetB.descriptorPtr() != attrSetD.descriptorPtr());
+        CPPUNIT_ASSERT(attrSetB.descriptor() == attrSetD.descriptor());
+    }
+
+    { // I/O descriptor reference test
+        std::ostringstream ostr(std::ios_base::binary);
+
+        // descriptors are only written as references once the stream has been reset
+
+        attrSetA.writeMetadata(ostr);
+        const size_t fullBytes = ostr.str().size();
+        attrSetA.writeMetadata(ostr);
+        CPPUNIT_ASSERT_EQUAL(ostr.str().size(), 2 * fullBytes);
+
+        ostr.str("");
+        AttributeSet::resetDescriptorStream(ostr);
+        attrSetA.writeMetadata(ostr);
+        CPPUNIT_ASSERT_EQUAL(ostr.str().size(), fullBytes);
+        attrSetA.writeMetadata(ostr);
+        const size_t referenceBytes = ostr.str().size() - fullBytes;
+
+        // the second descriptor is written as a reference to the first
+
+        CPPUNIT_ASSERT_EQUAL(referenceBytes, sizeof(openvdb::Index64));
+        CPPUNIT_ASSERT(fullBytes > referenceBytes);
+
+        // resetting the stream writes the next descriptor in full
+
+        AttributeSet::resetDescriptorStream(ostr);
+        attrSetA.writeMetadata(ostr);
+        CPPUNIT_ASSERT_EQUAL(ostr.str().size(), 2 * fullBytes + referenceBytes);
+
+        AttributeSet attrSetB, attrSetC, attrSetD;
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        attrSetB.readMetadata(istr);
+        attrSetC.readMetadata(istr);
+        AttributeSet::resetDescriptorStream(istr);
+        attrSetD.readMetadata(istr);
+
+        CPPUNIT_ASSERT(attrSetB.descriptor() == attrSetA.descriptor());
+        CPPUNIT_ASSERT_EQUAL(attrSetB.descriptorPtr(), attrSetC.descriptorPtr());
+        CPPUNIT_ASSERT(attrSetD.descriptor() == attrSetA.descriptor());
+
+        // a reference with no previous descriptor cannot be read
+
+        std::istringstream istr2(ostr.str().substr(fullBytes), std::ios_base::binary);
+        CPPUNIT_ASSERT_THROW(attrSetB.readMetadata(istr2), openvdb::IoError);
+    }
+
+    { // I/O legacy descriptor test
+        // attribute sets used to be written with the unversioned descriptor only
+
+        std::ostringstream ostr(std::ios_base::binary);
+        attrSetA.descriptor().write(ostr);
+        attrSetA.writeAttributes(ostr);
+        attrSetA.descriptor().write(ostr);
+        attrSetA.writeAttributes(ostr);
+
+        AttributeSet attrSetB, attrSetC;
+        std::istringstream istr(ostr.str(), std::ios_base::binary);
+        AttributeSet::resetDescriptorStream(istr);
+        attrSetB.read(istr);
+        attrSetC.read(istr);
+
+        CPPUNIT_ASSERT(matchingAttributeSets(attrSetA, attrSetB));
+        CPPUNIT_ASSERT(matchingAttributeSets(attrSetA, attrSetC));
+        CPPUNIT_ASSERT_EQUAL(attrSetB.descriptorPtr(), attrSetC.descriptorPtr());
+
+        // an unversioned descriptor cannot follow a versioned descriptor in the same grid
+
+        std::ostringstream ostr2(std::ios_base::binary);
+        attrSetA.write(ostr2);
+        attrSetA.descriptor().write(ostr2);
+
+        std::istringstream istr2(ostr2.str(), std::ios_base::binary);
+        attrSetB.read(istr2);
+        CPPUNIT_ASSERT_THROW(attrSetC.readMetadata(istr2), openvdb::IoError);
+
+        std::istringstream istr3(ostr2.str(), std::ios_base::binary);
+        attrSetB.read(istr3);
+        AttributeSet::resetDescriptorStream(istr3);
+        attrSetC.readMetadata(istr3);
+        CPPUNIT_ASSERT(attrSetC.descriptor() == attrSetA.descriptor());
+    }
+
+    { // I/O descriptor format version test
+        std::ostringstream ostr(std::ios_base::binary);
+        attrSetA.writeMetadata(ostr);
+
+        // the format version follows the token that marks a full descriptor
+
+        std::string buffer = ostr.str();
+        const openvdb::Index32 version = AttributeSet::FORMAT_CURRENT + 1;
+        buffer.replace(sizeof(openvdb::Index64), sizeof(openvdb::Index32),
+            reinterpret_cast<const char*>(&version), sizeof(openvdb::Index32));
+
+        AttributeSet attrSetB;
+        std::istringstream istr(buffer, std::ios_base::binary);
+        CPPUNIT_ASSERT_THROW(attrSetB.readMetadata(istr), openvdb::IoError);
+    }
+
     { // I/O transient test
         AttributeArray* array = attrSetA.get(0);
         array->setTransient(true);
@@ -490,6 +490,21 @@ TestPointAttribute::testBloscCompress()
 
     CPPUNIT_ASSERT(leafIter->attributeArray("id").memUsage() < leafIter->attributeArray("id2").memUsage());
 #endif
+
+    // compress using specific settings
+
+    const attribute_compression::Settings settings(attribute_compression::Settings::BLOSCLZ, /*level=*/5);
+
+    bloscCompressAttribute(tree, "id2", settings);
+
+    CPPUNIT_ASSERT(leafIter->attributeArray("id2").compressionSettings() == settings);
+    CPPUNIT_ASSERT(leafIter2->attributeArray("id2").compressionSettings() == settings);
+    CPPUNIT_ASSERT(leafIter->attributeArray("id").compressionSettings() != settings);
+
+#ifdef OPENVDB_USE_BLOSC
+    CPPUNIT_ASSERT(leafIter->attributeArray("id2").isCompressed());
+    CPPUNIT_ASSERT(leafIter2->attributeArray("id2").isCompressed());
+#endif
 }
 
 
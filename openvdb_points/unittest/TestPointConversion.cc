@@ -50,11 +50,13 @@ public:
     CPPUNIT_TEST_SUITE(TestPointConversion);
     CPPUNIT_TEST(testPointConversion);
     CPPUNIT_TEST(testStride);
+    CPPUNIT_TEST(testQuantizePositions);
 
     CPPUNIT_TEST_SUITE_END();
 
     void testPointConversion();
     void testStride();
+    void testQuantizePositions();
 
 }; // class TestPointConversion
 
@@ -551,6 +553,114 @@ TestPointConversion::testStride()
 }
 
 
+////////////////////////////////////////
+
+
+void
+TestPointConversion::testQuantizePositions()
+{
+    typedef TypedAttributeArray<Vec3f, QuantizedPositionCodec>  AttributeQ;
+
+    // generate points
+
+    const unsigned long count(40000);
+
+    AttributeWrapper<Vec3f> position(1);
+    AttributeWrapper<int> xyz(1);
+    AttributeWrapper<int> id(1);
+    AttributeWrapper<float> uniform(1);
+    AttributeWrapper<openvdb::Name> string(1);
+    GroupWrapper group;
+
+    genPoints(count, /*scale=*/ 100.0, /*stride=*/false,
+                position, xyz, id, uniform, string, group);
+
+    const float voxelSize = 0.5f;
+    openvdb::math::Transform::Ptr transform(openvdb::math::Transform::createLinearTransform(voxelSize));
+
+    PointDataGrid::Ptr grid = createPointDataGrid<QuantizedPositionCodec, PointDataGrid>(
+        position.buffer(), *transform);
+    PointDataGrid::Ptr reference = grid->deepCopy();
+
+    CPPUNIT_ASSERT_THROW(quantizePositions(*grid, /*tolerance=*/0.0f), openvdb::ValueError);
+
+    const float tolerance = 0.01f;
+
+    quantizePositions(*grid, tolerance);
+
+    // every leaf is quantized and no world space position moves by more than the tolerance
+
+    PointDataTree::LeafCIter referenceIter = reference->tree().cbeginLeaf();
+
+    for (PointDataTree::LeafCIter leafIter = grid->tree().cbeginLeaf(); leafIter; ++leafIter, ++referenceIter) {
+
+        CPPUNIT_ASSERT(referenceIter);
+
+        const AttributeArray& array = leafIter->constAttributeArray("P");
+
+        CPPUNIT_ASSERT(array.isType<AttributeQ>());
+        CPPUNIT_ASSERT(array.isCompressed());
+        CPPUNIT_ASSERT(array.compressionSettings().tolerance > 0.0f);
+
+        AttributeHandle<Vec3f> handle(array);
+        AttributeHandle<Vec3f> referenceHandle(referenceIter->constAttributeArray("P"));
+
+        CPPUNIT_ASSERT(array.isCompressed());
+
+        for (Index i = 0; i < handle.size(); i++) {
+            const Vec3d difference = (handle.get(i) - referenceHandle.get(i)) * voxelSize;
+            CPPUNIT_ASSERT(difference.length() <= tolerance);
+        }
+    }
+
+    // no world space position moves by more than the tolerance with a sheared transform,
+    // for which the largest voxel dimension doesn't bound how far the index axes stretch
+
+    openvdb::math::Mat4d shear(openvdb::math::Mat4d::identity());
+    shear[0][0] = voxelSize;
+    shear[1][1] = voxelSize;
+    shear[2][2] = voxelSize;
+    shear[1][0] = 2.0 * voxelSize;
+
+    openvdb::math::Transform::Ptr shearTransform(
+        openvdb::math::Transform::createLinearTransform(shear));
+
+    grid = createPointDataGrid<QuantizedPositionCodec, PointDataGrid>(
+        position.buffer(), *shearTransform);
+    reference = grid->deepCopy();
+
+    quantizePositions(*grid, tolerance);
+
+    referenceIter = reference->tree().cbeginLeaf();
+
+    for (PointDataTree::LeafCIter leafIter = grid->tree().cbeginLeaf(); leafIter; ++leafIter, ++referenceIter) {
+
+        CPPUNIT_ASSERT(referenceIter);
+
+        const AttributeArray& array = leafIter->constAttributeArray("P");
+
+        CPPUNIT_ASSERT(array.isCompressed());
+
+        AttributeHandle<Vec3f> handle(array);
+        AttributeHandle<Vec3f> referenceHandle(referenceIter->constAttributeArray("P"));
+
+        for (Index i = 0; i < handle.size(); i++) {
+            const Vec3d difference = shearTransform->indexToWorld(Vec3d(handle.get(i))) -
+                shearTransform->indexToWorld(Vec3d(referenceHandle.get(i)));
+            CPPUNIT_ASSERT(difference.length() <= tolerance);
+        }
+    }
+
+    // positions can only be quantized with a linear transform
+
+    openvdb::math::Transform::Ptr frustum(openvdb::math::Transform::createFrustumTransform(
+        BBoxd(Vec3d(0), Vec3d(10)), /*taper=*/0.5, /*depth=*/10.0));
+    grid->setTransform(frustum);
+
+    CPPUNIT_ASSERT_THROW(quantizePositions(*grid, tolerance), openvdb::ValueError);
+}
+
+
 // Copyright (c) 2015-2016 Double Negative Visual Effects
 // All rights reserved. This software is distributed under the
 // Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
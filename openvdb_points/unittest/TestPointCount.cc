@@ -204,6 +204,26 @@ TestPointCount::testCount()
     CPPUNIT_ASSERT_EQUAL(pointCount(tree), Index64(LeafType::SIZE / 2 + LeafType::SIZE - 1));
     CPPUNIT_ASSERT_EQUAL(activePointCount(tree), Index64(LeafType::SIZE / 2 + LeafType::SIZE - 1));
     CPPUNIT_ASSERT_EQUAL(inactivePointCount(tree), Index64(0));
+
+    // de-activate voxels in the second leaf and compare counts from the voxel offsets
+    // with counts by iteration
+
+    leaf2.setValueOff(5);
+    leaf2.setValueOff(300);
+    leaf2.setValueOff(LeafType::SIZE - 1);
+
+    CPPUNIT_ASSERT_EQUAL(leaf2.onPointCount(), Index64(LeafType::SIZE - 4));
+    CPPUNIT_ASSERT_EQUAL(leaf2.offPointCount(), Index64(3));
+
+    for (PointDataTree::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
+        CPPUNIT_ASSERT_EQUAL(iter->pointCount(), iterCount(iter->beginIndexAll()));
+        CPPUNIT_ASSERT_EQUAL(iter->onPointCount(), iterCount(iter->beginIndexOn()));
+        CPPUNIT_ASSERT_EQUAL(iter->offPointCount(), iterCount(iter->beginIndexOff()));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(pointCount(tree), Index64(LeafType::SIZE / 2 + LeafType::SIZE - 1));
+    CPPUNIT_ASSERT_EQUAL(activePointCount(tree), Index64(LeafType::SIZE / 2 + LeafType::SIZE - 4));
+    CPPUNIT_ASSERT_EQUAL(inactivePointCount(tree), Index64(3));
 }
 
 
@@ -32,8 +32,15 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <openvdb_points/tools/PointDataGrid.h>
+#include <openvdb_points/tools/PointConversion.h>
+#include <openvdb_points/tools/PointCount.h>
 #include <openvdb_points/openvdb.h>
 #include <openvdb/openvdb.h>
+#include <openvdb/io/File.h>
+
+#include <cstdio> // for std::remove()
+#include <cstdlib> // for std::getenv()
+#include <limits>
 
 class TestPointDataLeaf: public CppUnit::TestCase
 {
@@ -52,6 +59,7 @@ public:
     CPPUNIT_TEST(testEquivalence);
     CPPUNIT_TEST(testIterators);
     CPPUNIT_TEST(testIO);
+    CPPUNIT_TEST(testClip);
     CPPUNIT_TEST(testSwap);
     CPPUNIT_TEST(testCopyOnWrite);
     CPPUNIT_TEST(testCopyDescriptor);
@@ -66,6 +74,7 @@ public:
     void testEquivalence();
     void testIterators();
     void testIO();
+    void testClip();
     void testSwap();
     void testCopyOnWrite();
     void testCopyDescriptor();
@@ -971,6 +980,219 @@ TestPointDataLeaf::testIO()
         CPPUNIT_ASSERT_EQUAL(leaf2.getValue(4), ValueType(20));
         CPPUNIT_ASSERT_EQUAL(leaf2.attributeSet().size(), size_t(2));
     }
+
+    // read buffers clipped to a bounding box
+
+    {
+        // two points in the first voxel and two points in the last voxel
+
+        LeafType leaf3(openvdb::Coord(0, 0, 0));
+        leaf3.initializeAttributes(Descriptor::create(AttributeVec3s::attributeType()), /*arrayLength=*/4);
+
+        Descriptor::Ptr descrB = leaf3.attributeSet().descriptor().duplicateAppend(
+            "density", AttributeF::attributeType());
+        leaf3.appendAttribute(leaf3.attributeSet().descriptor(), descrB, descrB->find("density"));
+
+        std::vector<ValueType> offsets(LeafType::SIZE, ValueType(2));
+        offsets.back() = ValueType(4);
+        leaf3.setOffsets(offsets);
+
+        TypedAttributeArray<float>& density =
+            TypedAttributeArray<float>::cast(leaf3.attributeArray("density"));
+
+        for (openvdb::Index i = 0; i < 4; i++)    density.set(i, float(i));
+
+        std::ostringstream ostr(std::ios_base::binary);
+        leaf3.writeTopology(ostr);
+        leaf3.writeBuffers(ostr);
+
+        // bounding box containing only the last voxel
+
+        {
+            LeafType leaf4(openvdb::Coord(0, 0, 0));
+
+            std::istringstream istr(ostr.str(), std::ios_base::binary);
+            openvdb::io::setCurrentVersion(istr);
+
+            leaf4.readTopology(istr);
+            leaf4.readBuffers(istr, openvdb::CoordBBox(openvdb::Coord(4), openvdb::Coord(10)));
+
+            CPPUNIT_ASSERT_NO_THROW(leaf4.validateOffsets());
+
+            CPPUNIT_ASSERT(!leaf4.isValueOn(0));
+            CPPUNIT_ASSERT(leaf4.isValueOn(LeafType::SIZE - 1));
+            CPPUNIT_ASSERT_EQUAL(leaf4.getValue(0), ValueType(0));
+            CPPUNIT_ASSERT_EQUAL(leaf4.getValue(LeafType::SIZE - 1), ValueType(2));
+
+            const TypedAttributeArray<float>& density4 =
+                TypedAttributeArray<float>::cast(leaf4.constAttributeArray("density"));
+
+            CPPUNIT_ASSERT_EQUAL(density4.size(), size_t(2));
+            CPPUNIT_ASSERT_EQUAL(density4.get(0), 2.0f);
+            CPPUNIT_ASSERT_EQUAL(density4.get(1), 3.0f);
+            CPPUNIT_ASSERT_EQUAL(leaf4.constAttributeArray("P").size(), size_t(2));
+        }
+
+        // bounding box containing the entire leaf
+
+        {
+            LeafType leaf4(openvdb::Coord(0, 0, 0));
+
+            std::istringstream istr(ostr.str(), std::ios_base::binary);
+            openvdb::io::setCurrentVersion(istr);
+
+            leaf4.readTopology(istr);
+            leaf4.readBuffers(istr, openvdb::CoordBBox(openvdb::Coord(-10), openvdb::Coord(10)));
+
+            CPPUNIT_ASSERT_EQUAL(leaf4.getValue(0), ValueType(2));
+            CPPUNIT_ASSERT_EQUAL(leaf4.constAttributeArray("density").size(), size_t(4));
+        }
+
+        // bounding box outside of the leaf
+
+        {
+            LeafType leaf4(openvdb::Coord(0, 0, 0));
+
+            std::istringstream istr(ostr.str(), std::ios_base::binary);
+            openvdb::io::setCurrentVersion(istr);
+
+            leaf4.readTopology(istr);
+            leaf4.readBuffers(istr, openvdb::CoordBBox(openvdb::Coord(20), openvdb::Coord(30)));
+
+            CPPUNIT_ASSERT_EQUAL(leaf4.onVoxelCount(), openvdb::Index64(0));
+            CPPUNIT_ASSERT_EQUAL(leaf4.getValue(LeafType::SIZE - 1), ValueType(0));
+        }
+    }
+}
+
+
+void
+TestPointDataLeaf::testClip()
+{
+    using namespace openvdb::tools;
+
+    typedef TypedAttributeArray<openvdb::Vec3f, QuantizedPositionCodec>   AttributeQ;
+
+    // points on a sphere with a radius of ten voxels, spanning several leaves
+
+    std::vector<openvdb::Vec3R> points;
+    genPoints(10000, points);
+
+    std::vector<openvdb::Vec3s> positions;
+    for (size_t i = 0; i < points.size(); i++)  positions.push_back(openvdb::Vec3s(points[i]));
+
+    const float voxelSize = 0.1f;
+    openvdb::math::Transform::Ptr transform(
+        openvdb::math::Transform::createLinearTransform(voxelSize));
+
+    PointDataGrid::Ptr grid = createPointDataGrid<QuantizedPositionCodec, PointDataGrid>(
+        positions, *transform);
+    grid->setName("points");
+
+    const float tolerance = 0.001f;
+
+    quantizePositions(*grid, tolerance);
+
+    // clipping a leaf removes the points outside of the bounding box and clipping
+    // it a second time (as a clipped read does) leaves it unchanged
+
+    {
+        PointDataTree::LeafCIter leafIter = grid->tree().cbeginLeaf();
+        while (leafIter->onVoxelCount() < 2)    ++leafIter;
+
+        LeafType leaf(*leafIter);
+
+        // bounding box containing only the first active voxel
+
+        const openvdb::Coord ijk = leaf.cbeginValueOn().getCoord();
+        const openvdb::CoordBBox bbox(ijk, ijk);
+
+        leaf.clip(bbox, ValueType(0));
+
+        CPPUNIT_ASSERT_NO_THROW(leaf.validateOffsets());
+
+        const Index64 clippedCount = leaf.pointCount();
+
+        CPPUNIT_ASSERT(clippedCount < leafIter->pointCount());
+        CPPUNIT_ASSERT_EQUAL(leaf.constAttributeArray("P").size(), size_t(clippedCount));
+
+        for (LeafType::ValueOnCIter iter = leaf.cbeginValueOn(); iter; ++iter) {
+            CPPUNIT_ASSERT(bbox.isInside(iter.getCoord()));
+        }
+
+        leaf.clip(bbox, ValueType(0));
+
+        CPPUNIT_ASSERT_EQUAL(leaf.pointCount(), clippedCount);
+        CPPUNIT_ASSERT_EQUAL(leaf.constAttributeArray("P").size(), size_t(clippedCount));
+    }
+
+    // write out grid to a temp file
+
+    std::string tempDir(std::getenv("TMPDIR"));
+    if (tempDir.empty())    tempDir = P_tmpdir;
+
+    const std::string filename = tempDir + "/openvdb_test_point_clip";
+
+    {
+        openvdb::io::File fileOut(filename);
+
+        openvdb::GridCPtrVec grids;
+        grids.push_back(grid);
+
+        fileOut.write(grids);
+    }
+
+    // read the grid clipped to a bounding box that partially overlaps leaves
+
+    const openvdb::BBoxd bbox(openvdb::Vec3d(0.0), openvdb::Vec3d(0.55, 1.0, 1.0));
+
+    openvdb::io::File fileIn(filename);
+    fileIn.open();
+
+    PointDataGrid::Ptr clipped = openvdb::GridBase::grid<PointDataGrid>(
+        fileIn.readGrid("points", bbox));
+
+    fileIn.close();
+
+    CPPUNIT_ASSERT(clipped);
+
+    const Index64 count = pointCount(clipped->tree());
+
+    CPPUNIT_ASSERT(count > Index64(0));
+    CPPUNIT_ASSERT(count < Index64(positions.size()));
+
+    // every retained point lies in a voxel inside the bounding box, within the tolerance
+    // the positions were quantized with (clipped positions are not quantized again)
+
+    openvdb::BBoxd voxelBBox(bbox);
+    voxelBBox.expand(0.5 * voxelSize + tolerance);
+
+    for (PointDataTree::LeafCIter leafIter = clipped->tree().cbeginLeaf(); leafIter; ++leafIter) {
+
+        CPPUNIT_ASSERT_NO_THROW(leafIter->validateOffsets());
+
+        const AttributeArray& array = leafIter->constAttributeArray("P");
+
+        CPPUNIT_ASSERT(array.isType<AttributeQ>());
+
+        AttributeHandle<openvdb::Vec3f> handle(array);
+
+        for (LeafType::IndexOnIter iter = leafIter->beginIndexOn(); iter; ++iter) {
+            const openvdb::Vec3d xyz = iter.getCoord().asVec3d();
+            const openvdb::Vec3d position = transform->indexToWorld(xyz + handle.get(*iter));
+
+            CPPUNIT_ASSERT(voxelBBox.isInside(position));
+
+            double distance = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < points.size(); i++) {
+                distance = std::min(distance, (position - points[i]).length());
+            }
+
+            CPPUNIT_ASSERT(distance <= tolerance);
+        }
+    }
+
+    std::remove(filename.c_str());
 }
 
 
@@ -37,6 +37,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <set>
 
 using namespace openvdb;
 using namespace openvdb::tools;
@@ -53,6 +54,7 @@ public:
     CPPUNIT_TEST(testCompact);
     CPPUNIT_TEST(testSet);
     CPPUNIT_TEST(testFilter);
+    CPPUNIT_TEST(testOperations);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -61,6 +63,7 @@ public:
     void testCompact();
     void testSet();
     void testFilter();
+    void testOperations();
 }; // class TestPointGroup
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TestPointGroup);
@@ -300,6 +303,51 @@ TestPointGroup::testAppendDrop()
         CPPUNIT_ASSERT_EQUAL(attributeSet.descriptor().groupMap().size(), size_t(0));
         CPPUNIT_ASSERT_EQUAL(attributeSet.descriptor().count(GroupAttributeArray::attributeType()), size_t(0));
     }
+
+    { // append and drop many groups at once
+        std::vector<Name> names;
+        for (int i = 0; i < 20; i++) {
+            std::stringstream ss;
+            ss << "batch" << i;
+            names.push_back(ss.str());
+        }
+
+        // repeated names are only appended once
+
+        names.push_back("batch3");
+
+        appendGroups(tree, names);
+
+        const AttributeSet::Descriptor& descriptor = attributeSet.descriptor();
+
+        CPPUNIT_ASSERT_EQUAL(descriptor.groupMap().size(), size_t(20));
+        CPPUNIT_ASSERT_EQUAL(descriptor.count(GroupAttributeArray::attributeType()), size_t(3));
+        CPPUNIT_ASSERT_EQUAL(&descriptor, &attributeSet4.descriptor());
+        CPPUNIT_ASSERT(attributeSet4.descriptor().hasGroup("batch19"));
+
+        std::set<size_t> offsets;
+        for (AttributeSet::Descriptor::ConstIterator it = descriptor.groupMap().begin(),
+            itEnd = descriptor.groupMap().end(); it != itEnd; ++it) {
+            offsets.insert(it->second);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(offsets.size(), size_t(20));
+        CPPUNIT_ASSERT_EQUAL(*offsets.rbegin(), size_t(19));
+
+        names.resize(10);
+
+        dropGroups(tree, names);
+
+        CPPUNIT_ASSERT_EQUAL(attributeSet.descriptor().groupMap().size(), size_t(10));
+        CPPUNIT_ASSERT_EQUAL(attributeSet.descriptor().count(GroupAttributeArray::attributeType()), size_t(2));
+        CPPUNIT_ASSERT(!attributeSet4.descriptor().hasGroup("batch0"));
+        CPPUNIT_ASSERT(attributeSet4.descriptor().hasGroup("batch10"));
+
+        CPPUNIT_ASSERT_THROW(appendGroups(tree, std::vector<Name>(1, "")), openvdb::KeyError);
+        CPPUNIT_ASSERT_THROW(dropGroups(tree, std::vector<Name>(1, "")), openvdb::KeyError);
+
+        dropGroups(tree);
+    }
 }
 
 
@@ -399,6 +447,78 @@ TestPointGroup::testCompact()
         CPPUNIT_ASSERT_EQUAL(tree2.cbeginLeaf()->attributeSet().descriptor().groupMap().size(), size_t(4));
         CPPUNIT_ASSERT_EQUAL(tree2.cbeginLeaf()->attributeSet().descriptor().count(GroupAttributeArray::attributeType()), size_t(3));
     }
+
+    { // compaction moving many groups preserves membership
+        typedef PointIndexGrid PointIndexGrid;
+
+        std::vector<Vec3s> manyPositions;
+        for (int i = 0; i < 100; i++) {
+            manyPositions.push_back(Vec3s(1, 1, 1));
+        }
+
+        const PointAttributeVector<Vec3s> pointList(manyPositions);
+
+        PointIndexGrid::Ptr pointIndexGrid =
+            openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+        PointDataGrid::Ptr manyGrid =
+            createPointDataGrid<NullCodec, PointDataGrid>(*pointIndexGrid, pointList, *transform);
+        PointDataTree& manyTree = manyGrid->tree();
+
+        std::vector<Name> names;
+        for (int i = 0; i < 24; i++) {
+            ss.str("");
+            ss << "test" << i;
+            names.push_back(ss.str());
+        }
+
+        appendGroups(manyTree, names);
+
+        CPPUNIT_ASSERT_EQUAL(manyTree.cbeginLeaf()->attributeSet().descriptor().count(GroupAttributeArray::attributeType()), size_t(3));
+
+        // group i contains every (i+2)th point, groups 7 and 21 contain all points
+
+        for (int i = 0; i < 24; i++) {
+            if (i == 7 || i == 21) {
+                setGroup(manyTree, names[i], true);
+                continue;
+            }
+
+            std::vector<short> membership;
+            for (int n = 0; n < 100; n++) {
+                membership.push_back(short(n % (i + 2) == 0));
+            }
+
+            setGroup(manyTree, pointIndexGrid->tree(), membership, names[i]);
+        }
+
+        // keep only groups spread across all three attributes
+
+        std::vector<Name> dropNames;
+        for (int i = 0; i < 24; i++) {
+            if (i == 2 || i == 7 || i == 12 || i == 17 || i == 21 || i == 23)  continue;
+            dropNames.push_back(names[i]);
+        }
+
+        dropGroups(manyTree, dropNames);
+
+        const AttributeSet::Descriptor& descriptor = manyTree.cbeginLeaf()->attributeSet().descriptor();
+
+        CPPUNIT_ASSERT_EQUAL(descriptor.groupMap().size(), size_t(6));
+        CPPUNIT_ASSERT_EQUAL(descriptor.count(GroupAttributeArray::attributeType()), size_t(1));
+
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(manyTree, "test7"), Index64(100));
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(manyTree, "test21"), Index64(100));
+
+        for (int i = 0; i < 24; i++) {
+            if (!descriptor.hasGroup(names[i]) || i == 7 || i == 21)    continue;
+
+            const Index64 expected = Index64((99 / (i + 2)) + 1);
+
+            CPPUNIT_ASSERT(descriptor.groupMap().find(names[i])->second < size_t(6));
+            CPPUNIT_ASSERT_EQUAL(groupPointCount(manyTree, names[i]), expected);
+        }
+    }
 }
 
 
@@ -655,6 +775,124 @@ TestPointGroup::testFilter()
 }
 
 
+void
+TestPointGroup::testOperations()
+{
+    using namespace openvdb;
+    using namespace openvdb::tools;
+
+    typedef PointIndexGrid PointIndexGrid;
+
+    // points in two leafs, more than one word of points in the first leaf
+
+    std::vector<Vec3s> positions;
+    for (int i = 0; i < 200; i++) {
+        positions.push_back(Vec3s(1, 1, 1));
+    }
+    for (int i = 0; i < 100; i++) {
+        positions.push_back(Vec3s(100, 100, 100));
+    }
+
+    const float voxelSize(1.0);
+    math::Transform::Ptr transform(math::Transform::createLinearTransform(voxelSize));
+
+    const PointAttributeVector<Vec3s> pointList(positions);
+
+    PointIndexGrid::Ptr pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<PointIndexGrid>(pointList, *transform);
+
+    PointDataGrid::Ptr grid = createPointDataGrid<NullCodec, PointDataGrid>(*pointIndexGrid, pointList, *transform);
+    PointDataTree& tree = grid->tree();
+
+    std::vector<Name> groups;
+    groups.push_back("even");
+    groups.push_back("three");
+    groups.push_back("result");
+    groups.push_back("all");
+
+    appendGroups(tree, groups);
+
+    std::vector<short> even, three;
+
+    Index64 unionCount(0), intersectionCount(0), differenceCount(0), complementCount(0);
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        even.push_back(short(i % 2 == 0));
+        three.push_back(short(i % 3 == 0));
+
+        if (i % 2 == 0 || i % 3 == 0)   unionCount++;
+        if (i % 2 == 0 && i % 3 == 0)   intersectionCount++;
+        if (i % 2 == 0 && i % 3 != 0)   differenceCount++;
+        if (i % 2 != 0)                 complementCount++;
+    }
+
+    setGroup(tree, pointIndexGrid->tree(), even, "even");
+    setGroup(tree, pointIndexGrid->tree(), three, "three");
+    setGroup(tree, "all", true);
+
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "even"), Index64(150));
+    CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "three"), Index64(100));
+
+    std::vector<Name> sources;
+    sources.push_back("even");
+    sources.push_back("three");
+
+    { // union
+        setGroupByUnion(tree, "result", sources);
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "result"), unionCount);
+    }
+
+    { // intersection
+        setGroupByIntersection(tree, "result", sources);
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "result"), intersectionCount);
+    }
+
+    { // difference
+        setGroupByDifference(tree, "result", "even", std::vector<Name>(1, "three"));
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "result"), differenceCount);
+
+        for (PointDataTree::LeafCIter iter = tree.cbeginLeaf(); iter; ++iter) {
+            GroupHandle evenHandle = iter->groupHandle("even");
+            GroupHandle threeHandle = iter->groupHandle("three");
+            GroupHandle resultHandle = iter->groupHandle("result");
+
+            for (Index i = 0; i < resultHandle.size(); i++) {
+                CPPUNIT_ASSERT_EQUAL(resultHandle.get(i), evenHandle.get(i) && !threeHandle.get(i));
+            }
+        }
+    }
+
+    { // complement
+        setGroupByComplement(tree, "result", "even");
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "result"), complementCount);
+    }
+
+    { // target group as a source
+        setGroupByUnion(tree, "three", sources);
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "three"), unionCount);
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "even"), Index64(150));
+
+        setGroupByComplement(tree, "three", "three");
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "three"), Index64(300) - unionCount);
+    }
+
+    { // uniform sources
+        setGroupByComplement(tree, "result", "all");
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "result"), Index64(0));
+
+        setGroupByIntersection(tree, "result", std::vector<Name>(2, "all"));
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "result"), Index64(300));
+        CPPUNIT_ASSERT_EQUAL(groupPointCount(tree, "all"), Index64(300));
+    }
+
+    { // invalid groups
+        CPPUNIT_ASSERT_THROW(setGroupByUnion(tree, "missing", sources), LookupError);
+        CPPUNIT_ASSERT_THROW(setGroupByUnion(tree, "result", std::vector<Name>(1, "missing")), LookupError);
+        CPPUNIT_ASSERT_THROW(setGroupByUnion(tree, "result", std::vector<Name>()), ValueError);
+    }
+}
+
+
 // Copyright (c) 2015-2016 Double Negative Visual Effects
 // All rights reserved. This software is distributed under the
 // Mozilla Public License 2.0 ( http://www.mozilla.org/MPL/2.0/ )
@@ -35,6 +35,8 @@
 #include <openvdb_points/tools/PointDataGrid.h>
 #include <openvdb_points/tools/PointConversion.h>
 #include <openvdb_points/tools/PointLoad.h>
+#include <openvdb_points/tools/PointAttribute.h>
+#include <openvdb_points/tools/PointGroup.h>
 #include <openvdb_points/tools/AttributeArray.h>
 #include <openvdb_points/tools/AttributeSet.h>
 #include <openvdb/Types.h>
@@ -93,6 +95,9 @@ TestPointLoad::testLoad()
 
     CPPUNIT_ASSERT_EQUAL(tree2.leafCount(), Index32(4));
 
+    appendAttribute<AttributeI>(tree2, "id");
+    appendGroup(tree2, "test");
+
     // write out grid to a temp file
     {
         filename = tempDir + "/openvdb_test_point_load";
@@ -174,12 +179,112 @@ TestPointLoad::testLoad()
 
         leafIter = grid->tree().cbeginLeaf();
 
-        // only first and third leaf loaded into memory
+        // only first and third leaf loaded into memory (including attributes)
 
-        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore()); ++leafIter;
-        CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore()); ++leafIter;
-        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore()); ++leafIter;
+        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE)); ++leafIter;
         CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE); ++leafIter;
+        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE)); ++leafIter;
+        CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE);
+
+        // a bounding box containing every leaf node (loaded by iterating over the leaf nodes)
+
+        BBoxd bboxAll(Vec3i(-100, -100, -100), Vec3i(100, 100, 100));
+
+        loadPoints(*grid, bboxAll);
+
+        for (leafIter = grid->tree().cbeginLeaf(); leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+            CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE));
+        }
+    }
+
+    // read and load leaf nodes by a bbox with more leaf node locations than an Index64 can count
+    {
+        io::File fileIn(filename);
+        fileIn.open();
+
+        GridPtrVecPtr grids = fileIn.getGrids();
+
+        fileIn.close();
+
+        PointDataGrid::Ptr grid = GridBase::grid<PointDataGrid>((*grids)[0]);
+
+        CPPUNIT_ASSERT(grid);
+
+        BBoxd bboxHuge(Vec3d(-1.0e8), Vec3d(1.0e8));
+
+        loadPoints(*grid, bboxHuge);
+
+        PointDataGrid::TreeType::LeafCIter leafIter = grid->tree().cbeginLeaf();
+
+        for (; leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+            CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE));
+        }
+    }
+
+    // read and load leaf nodes with only inactive points by bbox
+    {
+        io::File fileIn(filename);
+        fileIn.open();
+
+        GridPtrVecPtr grids = fileIn.getGrids();
+
+        fileIn.close();
+
+        PointDataGrid::Ptr grid = GridBase::grid<PointDataGrid>((*grids)[0]);
+
+        CPPUNIT_ASSERT(grid);
+
+        // deactivate the fourth leaf, which then lies outside of the active bounds
+
+        PointDataTree::LeafNodeType* leaf = grid->tree().probeLeaf(Coord(1, 1, 20));
+
+        CPPUNIT_ASSERT(leaf);
+
+        leaf->setValuesOff();
+
+        CoordBBox activeBBox;
+        grid->tree().evalLeafBoundingBox(activeBBox);
+
+        CPPUNIT_ASSERT(!activeBBox.isInside(Coord(1, 1, 20)));
+
+        BBoxd bbox(Vec3i(0, 0, 18), Vec3i(4, 4, 22));
+
+        loadPoints(*grid, bbox);
+
+        PointDataGrid::TreeType::LeafCIter leafIter = grid->tree().cbeginLeaf();
+
+        // only the fourth leaf loaded into memory (including attributes)
+
+        CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore()); ++leafIter;
+        CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore()); ++leafIter;
+        CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore()); ++leafIter;
+        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE));
+
+        // deactivate every leaf, which leaves the tree with no active bounds
+
+        for (PointDataTree::LeafIter iter = grid->tree().beginLeaf(); iter; ++iter) {
+            iter->setValuesOff();
+        }
+
+        grid->tree().evalLeafBoundingBox(activeBBox);
+
+        CPPUNIT_ASSERT(activeBBox.empty());
+
+        BBoxd bboxAll(Vec3i(-100, -100, -100), Vec3i(100, 100, 100));
+
+        loadPoints(*grid, bboxAll);
+
+        for (leafIter = grid->tree().cbeginLeaf(); leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+            CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE));
+        }
     }
 #endif
 
@@ -213,19 +318,166 @@ TestPointLoad::testLoad()
         mask->tree().touchLeaf(Coord(0, 0, 0));
         mask->tree().touchLeaf(Coord(1, 1, 20));
 
-        loadPoints(*grid, *mask);
+        loadPoints(*grid, *mask, /*prefetch=*/true);
 
         leafIter = grid->tree().cbeginLeaf();
 
         // only first and second leaves loaded into memory
 
-        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore()); ++leafIter;
-        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore()); ++leafIter;
+        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE)); ++leafIter;
+        CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+        CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE)); ++leafIter;
         CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore()); ++leafIter;
         CPPUNIT_ASSERT(leafIter->buffer().isOutOfCore());
     }
 #endif
 
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    // read and load selected attributes
+    {
+        io::File fileIn(filename);
+        fileIn.open();
+
+        GridPtrVecPtr grids = fileIn.getGrids();
+
+        fileIn.close();
+
+        CPPUNIT_ASSERT_EQUAL(grids->size(), size_t(1));
+
+        PointDataGrid::Ptr grid = GridBase::grid<PointDataGrid>((*grids)[0]);
+
+        CPPUNIT_ASSERT(grid);
+
+        std::vector<Name> attributes;
+        attributes.push_back("P");
+
+        loadAttributes(*grid, attributes);
+
+        // all leaves and positions loaded into memory, other attributes remain out of core
+
+        PointDataGrid::TreeType::LeafCIter leafIter = grid->tree().cbeginLeaf();
+
+        for (; leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(!leafIter->buffer().isOutOfCore());
+            CPPUNIT_ASSERT(!(leafIter->attributeArray("P").flags() & AttributeArray::OUTOFCORE));
+            CPPUNIT_ASSERT(leafIter->attributeArray("id").flags() & AttributeArray::OUTOFCORE);
+            CPPUNIT_ASSERT(leafIter->attributeArray("__group0").flags() & AttributeArray::OUTOFCORE);
+        }
+
+        // load group data only for leaves that overlap a bounding box
+
+        BBoxd bbox(Vec3i(0, 0, 0), Vec3i(4, 4, 4));
+
+        std::vector<Name> groups;
+        groups.push_back("test");
+
+        loadAttributes(*grid, bbox, std::vector<Name>(), groups);
+
+        leafIter = grid->tree().cbeginLeaf();
+
+        CPPUNIT_ASSERT(!(leafIter->attributeArray("__group0").flags() & AttributeArray::OUTOFCORE));
+        CPPUNIT_ASSERT(leafIter->attributeArray("id").flags() & AttributeArray::OUTOFCORE); ++leafIter;
+        CPPUNIT_ASSERT(leafIter->attributeArray("__group0").flags() & AttributeArray::OUTOFCORE);
+
+        // invalid attribute and group names
+
+        attributes.push_back("invalid");
+        CPPUNIT_ASSERT_THROW(loadAttributes(*grid, attributes), openvdb::KeyError);
+
+        groups.push_back("invalid");
+        CPPUNIT_ASSERT_THROW(loadAttributes(*grid, std::vector<Name>(), groups), openvdb::LookupError);
+    }
+#endif
+
+#ifndef OPENVDB_2_ABI_COMPATIBLE
+    // release loaded attributes back to disk
+    {
+        io::File fileIn(filename);
+        fileIn.open();
+
+        GridPtrVecPtr grids = fileIn.getGrids();
+
+        fileIn.close();
+
+        CPPUNIT_ASSERT_EQUAL(grids->size(), size_t(1));
+
+        PointDataGrid::Ptr grid = GridBase::grid<PointDataGrid>((*grids)[0]);
+
+        CPPUNIT_ASSERT(grid);
+
+        // nothing to release before loading
+
+        CPPUNIT_ASSERT_EQUAL(releaseAttributes(*grid), Index64(0));
+
+        loadPoints(*grid);
+
+        PointDataGrid::TreeType::LeafIter leafIter = grid->tree().beginLeaf();
+
+        for (; leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(leafIter->attributeArray("P").isReleasable());
+            CPPUNIT_ASSERT(leafIter->attributeArray("id").isReleasable());
+        }
+
+        CPPUNIT_ASSERT(releaseAttributes(*grid) > Index64(0));
+
+        for (leafIter = grid->tree().beginLeaf(); leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(leafIter->constAttributeArray("P").flags() & AttributeArray::OUTOFCORE);
+            CPPUNIT_ASSERT(leafIter->constAttributeArray("id").flags() & AttributeArray::OUTOFCORE);
+            CPPUNIT_ASSERT(!leafIter->constAttributeArray("P").isReleasable());
+        }
+
+        // released arrays are re-loaded on access
+
+        leafIter = grid->tree().beginLeaf();
+
+        AttributeHandle<Vec3f>::Ptr handle =
+            AttributeHandle<Vec3f>::create(leafIter->constAttributeArray("P"));
+
+        CPPUNIT_ASSERT(!(leafIter->constAttributeArray("P").flags() & AttributeArray::OUTOFCORE));
+        CPPUNIT_ASSERT(handle->get(0) == Vec3f(1, 1, 1));
+
+        handle.reset();
+
+        // modified arrays cannot be released
+
+        loadPoints(*grid);
+
+        AttributeWriteHandle<int>::Ptr writeHandle =
+            AttributeWriteHandle<int>::create(leafIter->attributeArray("id"));
+        writeHandle->set(0, 5);
+        writeHandle.reset();
+
+        CPPUNIT_ASSERT(!leafIter->constAttributeArray("id").isReleasable());
+
+        releaseAttributes(*grid);
+
+        CPPUNIT_ASSERT(!(leafIter->constAttributeArray("id").flags() & AttributeArray::OUTOFCORE));
+        CPPUNIT_ASSERT(leafIter->constAttributeArray("P").flags() & AttributeArray::OUTOFCORE);
+
+        // least recently used arrays are released first to meet the memory budget
+
+        loadPoints(*grid);
+
+        // the budget covers the positions and the modified array
+
+        Index64 budget = leafIter->constAttributeArray("id").memUsage();
+
+        for (leafIter = grid->tree().beginLeaf(); leafIter; ++leafIter) {
+            const AttributeArray& array = leafIter->constAttributeArray("P");
+            AttributeHandle<Vec3f>::create(array);
+            budget += array.memUsage();
+        }
+
+        releaseAttributes(*grid, budget);
+
+        for (leafIter = grid->tree().beginLeaf(); leafIter; ++leafIter) {
+            CPPUNIT_ASSERT(!(leafIter->constAttributeArray("P").flags() & AttributeArray::OUTOFCORE));
+            CPPUNIT_ASSERT(leafIter->constAttributeArray("__group0").flags() & AttributeArray::OUTOFCORE);
+        }
+    }
+#endif
+
     // cleanup temp files
 
     std::remove(filename.c_str());
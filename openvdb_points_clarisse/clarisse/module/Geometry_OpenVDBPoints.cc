@@ -36,6 +36,9 @@
 
 #include <openvdb_points/tools/PointCount.h>
 
+#include <boost/optional.hpp>
+#include <boost/utility/in_place_factory.hpp>
+
 #include "Geometry_OpenVDBPoints.h"
 
 using namespace openvdb;
@@ -672,15 +675,15 @@ void Geometry_OpenVDBPoints::intersect_typed_primitive(
 
     assert(leaf.attributeSet().find("P") != AttributeSet::INVALID_POS);
 
-    // obtain the attribute handles
+    // obtain the attribute handles (constructed in-place to avoid allocating per ray batch)
 
-    const AttributeHandle<Vec3f>::Ptr positionHandle = AttributeHandle<Vec3f>::create(leaf.attributeArray("P"));
+    const AttributeHandle<Vec3f> positionHandle(leaf.attributeArray("P"));
 
-    typename AttributeHandle<VelocityType>::Ptr velocityHandle;
-    typename AttributeHandle<RadiusType>::Ptr radiusHandle;
+    boost::optional<AttributeHandle<VelocityType> > velocityHandle;
+    boost::optional<AttributeHandle<RadiusType> > radiusHandle;
 
-    if (leaf.hasAttribute("v"))                             velocityHandle = AttributeHandle<VelocityType>::create(leaf.attributeArray("v"));
-    if (leaf.hasAttribute("pscale") && !m_overrideRadius)   radiusHandle = AttributeHandle<RadiusType>::create(leaf.attributeArray("pscale"));
+    if (leaf.hasAttribute("v"))                             velocityHandle = boost::in_place(leaf.attributeArray("v"));
+    if (leaf.hasAttribute("pscale") && !m_overrideRadius)   radiusHandle = boost::in_place(leaf.attributeArray("pscale"));
 
     // three-level leaf BVH tree:
     //     level1: 8x8x8 voxels
@@ -767,7 +770,7 @@ void Geometry_OpenVDBPoints::intersect_typed_primitive(
                 Vec3f positionValue;
                 RadiusType radiusValue;
 
-                positionValue = positionHandle->get(*iter);
+                positionValue = positionHandle.get(*iter);
 
                 // compute radius in index space (apply scaling if required)
 